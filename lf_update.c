@@ -1,21 +1,230 @@
+#define _GNU_SOURCE  // for asprintf
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
 #include <libpq-fe.h>
 
+// static tracepoints (USDT), which can be attached to with tools like bpftrace or perf and which are no-ops
+// otherwise; they are compiled in if the header file of SystemTap is available (see Makefile):
+#ifdef USE_SDT
+#include <sys/sdt.h>
+#else
+#define DTRACE_PROBE2(provider, name, arg1, arg2)
+#define DTRACE_PROBE4(provider, name, arg1, arg2, arg3, arg4)
+#endif
+
+// ordering of issues in admission state and of suggestions, compiled in from lf_update_issue_order.c and
+// lf_update_suggestion_order.c (see command line option "--cycle" and Makefile):
+int lf_update_issue_order(PGconn *db, PGconn *db_read);
+int lf_update_suggestion_order(PGconn *db, PGconn *db_read);
+void lf_update_issue_order_slow_log(char *filename, int threshold);
+void lf_update_suggestion_order_slow_log(char *filename, int threshold);
+void lf_update_issue_order_write_metrics(FILE *out);
+void lf_update_suggestion_order_write_metrics(FILE *out);
+
+// default budget for garbage collection (may be overridden on command line):
+#define GC_DEFAULT_BATCH_SIZE  1000    // rows deleted per transaction
+#define GC_DEFAULT_MAX_ROWS    100000  // rows deleted per run in total
+#define GC_DEFAULT_MAX_TIME    30      // seconds spent per run in total
+
+// retries of transactions which failed due to lock timeouts, serialization failures, or deadlocks:
+#define RETRY_COUNT     5    // maximum number of retries per SQL command
+#define RETRY_DELAY_MS  100  // delay before first retry, doubled with every further retry
+
+// SQLSTATE codes of errors after which a transaction may simply be retried:
+static int retryable_error(PGresult *res) {
+  char *sqlstate = PQresultErrorField(res, PG_DIAG_SQLSTATE);
+  if (!sqlstate) return 0;
+  return (
+    !strcmp(sqlstate, "55P03") ||  // lock_not_available (caused by lock_timeout)
+    !strcmp(sqlstate, "40001") ||  // serialization_failure
+    !strcmp(sqlstate, "40P01")     // deadlock_detected
+  );
+}
+
+// seconds passed since a given point in time (measured with a monotonic clock):
+static double seconds_since(struct timespec *start) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+// statistics of the current phase (see command line options "--timing" and "--metrics"):
+static int timing = 0;      // set to 1 to print statistics of each phase to stdout
+static struct {
+  char *name;               // name of the current phase (empty string outside of phases)
+  struct timespec start;    // time when the phase has been started
+  double db_time;           // seconds spent waiting for results of SQL commands
+  int round_trips;          // number of SQL commands sent (including retries)
+  long long rows;           // rows written in the database before the phase started (-1 if unknown)
+} phase_stats = { "" };
+
+// metrics of a run (see command line option "--metrics"):
+#define METRICS_MAX_PHASES 16
+static char *metrics_filename = NULL;  // file to write metrics to (NULL = disabled)
+static struct {
+  char *name;               // name of the phase (as passed to begin_phase(...))
+  double wall_time;         // sums over all occurrences of the phase (one per shard for some phases)
+  double db_time;
+  int round_trips;
+  long long rows;           // -1 if unknown
+} phase_metrics[METRICS_MAX_PHASES];
+static int phase_metrics_count = 0;
+static struct {
+  int issues_checked;       // issues for which "check_issue"(...) has been called
+  int phases_finished;      // issues which finished their phase or have been revoked (i.e. changed their state)
+  int snapshots_taken;      // snapshots taken for issue admission or by "check_issue"(...)
+  int snapshots_reused;     // areas whose latest snapshot has been still up to date
+  int admission_iterations; // calls of "issue_admission"(...)
+  int retries;              // transactions retried due to lock timeouts, serialization failures, or deadlocks
+  int ordered;              // set to 1 if issues and suggestions have been ordered (see option "--cycle")
+} metrics;
+
+// log of slow SQL commands with their plans (see command line options "--slow-log" and "--slow-threshold"):
+#define SLOW_LOG_DEFAULT_THRESHOLD  1000      // milliseconds
+#define SLOW_LOG_MAX_SIZE           10000000  // bytes, after which the log file is renamed to <file>.old
+static char *slow_log_filename = NULL;        // NULL = disabled
+static int slow_log_threshold = SLOW_LOG_DEFAULT_THRESHOLD;
+static char slow_log_object[64] = "";         // area or issue currently processed, e.g. "issue #17"
+static int slow_log_auto_explain = -1;        // 1 if module auto_explain has been loaded, 0 if not available, -1 if not tried yet
+
+// notice processor writing plans logged by auto_explain (see below) to the slow statement log:
+static void slow_log_notice(void *arg, const char *message) {
+  fputs(message, (FILE *)arg);
+}
+
+// append an entry for a slow SQL command (tagged with phase and current area or issue) to the slow statement
+// log, including its plan: the command is executed again within a transaction that is rolled back (i.e. after
+// the original transaction has been committed, such that the data may have changed in the meantime); if the
+// module auto_explain can be loaded, the plans of all nested statements are logged, otherwise the output of
+// EXPLAIN (ANALYZE, BUFFERS) is logged:
+static void log_slow_statement(PGconn *db, char *command, double duration) {
+  FILE *out;
+  struct stat sb;
+  time_t now;
+  char timestamp[20];
+  char *statement = command;  // command without "SET TRANSACTION ...;" and "SET LOCAL ...;" prefixes
+  char *begin = NULL;         // BEGIN command with transaction mode of command
+  char *settings = NULL;      // "SET LOCAL ...;" prefixes of command, executed after BEGIN
+  char *settings_start;
+  char *explain = NULL;
+  PGresult *res;
+  PQnoticeProcessor old_notice_processor;
+  int i;
+  // rename log file if it is too big, such that the size of the log is limited:
+  if (!stat(slow_log_filename, &sb) && sb.st_size >= SLOW_LOG_MAX_SIZE) {
+    char *old_filename;
+    if (asprintf(&old_filename, "%s.old", slow_log_filename) >= 0) {
+      rename(slow_log_filename, old_filename);
+      free(old_filename);
+    }
+  }
+  out = fopen(slow_log_filename, "a");
+  if (!out) {
+    fprintf(stderr, "Could not open slow statement log \"%s\".\n", slow_log_filename);
+    return;
+  }
+  now = time(NULL);
+  strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", localtime(&now));
+  fprintf(out, "=== %s phase=%s object=%s duration=%.3fms\n%s\n", timestamp, phase_stats.name[0] ? phase_stats.name : "-", slow_log_object[0] ? slow_log_object : "-", duration * 1000, command);
+  if (!strncmp(command, "SET TRANSACTION ", 16) && strchr(command, ';')) {
+    statement = strchr(command, ';') + 1;
+    while (*statement == ' ') statement++;
+    if (asprintf(&begin, "BEGIN %.*s", (int)(strchr(command, ';') - command - 16), command + 16) < 0) begin = NULL;
+  }
+  settings_start = statement;
+  while (!strncmp(statement, "SET LOCAL ", 10) && strchr(statement, ';')) {
+    statement = strchr(statement, ';') + 1;
+    while (*statement == ' ') statement++;
+  }
+  if (statement > settings_start) {
+    if (asprintf(&settings, "%.*s", (int)(statement - settings_start), settings_start) < 0) settings = NULL;
+  }
+  if (slow_log_auto_explain < 0) {
+    res = PQexec(db, "LOAD 'auto_explain'");
+    slow_log_auto_explain = PQresultStatus(res) == PGRES_COMMAND_OK;
+    PQclear(res);
+  }
+  old_notice_processor = PQsetNoticeProcessor(db, slow_log_notice, out);
+  res = PQexec(db, begin ? begin : "BEGIN");
+  free(begin);
+  if (PQresultStatus(res) == PGRES_COMMAND_OK && settings) {
+    PQclear(res);
+    res = PQexec(db, settings);
+  }
+  free(settings);
+  if (PQresultStatus(res) == PGRES_COMMAND_OK) {
+    PQclear(res);
+    if (slow_log_auto_explain) {
+      res = PQexec(db, "SET LOCAL \"client_min_messages\" = 'log'; SET LOCAL \"auto_explain.log_min_duration\" = 0; SET LOCAL \"auto_explain.log_analyze\" = TRUE; SET LOCAL \"auto_explain.log_buffers\" = TRUE; SET LOCAL \"auto_explain.log_nested_statements\" = TRUE");
+      if (PQresultStatus(res) == PGRES_COMMAND_OK) {
+        PQclear(res);
+        res = PQexec(db, statement);
+      }
+    } else if (asprintf(&explain, "EXPLAIN (ANALYZE, BUFFERS) %s", statement) >= 0) {
+      res = PQexec(db, explain);
+      free(explain);
+      if (PQresultStatus(res) == PGRES_TUPLES_OK) {
+        for (i=0; i<PQntuples(res); i++) fprintf(out, "%s\n", PQgetvalue(res, i, 0));
+      }
+    } else {
+      res = NULL;
+    }
+    if (PQresultStatus(res) != PGRES_COMMAND_OK && PQresultStatus(res) != PGRES_TUPLES_OK) {
+      fprintf(out, "Could not determine plan: %s", res ? PQresultErrorMessage(res) : "out of memory\n");
+    }
+  } else {
+    fprintf(out, "Could not start transaction: %s", PQresultErrorMessage(res));
+  }
+  PQclear(res);
+  if (PQtransactionStatus(db) != PQTRANS_IDLE) PQclear(PQexec(db, "ROLLBACK"));
+  PQsetNoticeProcessor(db, old_notice_processor, NULL);
+  fprintf(out, "\n");
+  fclose(out);
+}
+
 #define exec_sql_error(message) do { \
     fprintf(stderr, message ": %s\n%s", command, PQresultErrorMessage(res)); \
     goto exec_sql_error_clear; \
   } while (0)
 
+// execute an SQL command, with probes "exec_sql__start" (arguments: phase name and command) and "exec_sql__done"
+// (arguments: phase name, command, duration in nanoseconds including retries, and number of rows or -1 on error);
+// only the duration of the last attempt (without retries and delays) is compared with the slow threshold:
 int exec_sql(PGconn *db, PGresult **resptr, int *errptr, int onerow, char *command) {
   int count = 0;
-  PGresult *res = PQexec(db, command);
+  int retry;
+  PGresult *res;
+  struct timespec start, sent;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  DTRACE_PROBE2(lf_update, exec_sql__start, phase_stats.name, command);
+  // commands are executed in an implicit transaction (if not containing BEGIN),
+  // thus they can be repeated after backing off when blocked by other transactions:
+  for (retry=0; ; retry++) {
+    struct timespec delay;
+    clock_gettime(CLOCK_MONOTONIC, &sent);
+    res = PQexec(db, command);
+    phase_stats.db_time += seconds_since(&sent);
+    phase_stats.round_trips++;
+    if (!res || retry >= RETRY_COUNT) break;
+    if (PQresultStatus(res) != PGRES_FATAL_ERROR || !retryable_error(res)) break;
+    PQclear(res);
+    metrics.retries++;
+    delay.tv_sec  = (RETRY_DELAY_MS << retry) / 1000;
+    delay.tv_nsec = (long)((RETRY_DELAY_MS << retry) % 1000) * 1000000;
+    nanosleep(&delay, NULL);
+  }
   if (!res) {
     fprintf(stderr, "Error in pqlib while sending the following SQL command: %s\n", command);
     goto exec_sql_error_exit;
   }
+  if (slow_log_filename && seconds_since(&sent) * 1000 >= slow_log_threshold) log_slow_statement(db, command, seconds_since(&sent));
   if (
     PQresultStatus(res) != PGRES_COMMAND_OK &&
     PQresultStatus(res) != PGRES_TUPLES_OK
@@ -30,133 +239,332 @@ int exec_sql(PGconn *db, PGresult **resptr, int *errptr, int onerow, char *comma
     }
     *resptr = res;
   } else {
+    count = atoi(PQcmdTuples(res));  // number of affected rows (if any)
     PQclear(res);
   }
+  DTRACE_PROBE4(lf_update, exec_sql__done, phase_stats.name, command, (long long)(seconds_since(&start) * 1e9), count);
   return count;
   exec_sql_error_clear:
   PQclear(res);
   exec_sql_error_exit:
   if (resptr) *resptr = NULL;
   if (errptr) *errptr = 1;
+  DTRACE_PROBE4(lf_update, exec_sql__done, phase_stats.name, command, (long long)(seconds_since(&start) * 1e9), -1);
   return -1;
 }
 
-int main(int argc, char **argv) {
-
-  // variable declarations:
-  int err = 0;               /* set to 1 if any error occured */
-  int admission_failed = 0;  /* set to 1 if error occurred during admission */
-  int i, count;
-  char *conninfo;
-  PGconn *db;
+// number of rows written in the current database according to the cumulative statistics,
+// after flushing pending statistics of this session (if supported by the server); -1 if unknown:
+static long long rows_written(PGconn *db) {
   PGresult *res;
+  long long rows = -1;
+  if (PQserverVersion(db) >= 150000) PQclear(PQexec(db, "SELECT pg_stat_force_next_flush()"));
+  res = PQexec(db, "SELECT \"tup_inserted\" + \"tup_updated\" + \"tup_deleted\" FROM \"pg_stat_database\" WHERE \"datname\" = current_database()");
+  if (PQresultStatus(res) == PGRES_TUPLES_OK && PQntuples(res) == 1) rows = atoll(PQgetvalue(res, 0, 0));
+  PQclear(res);
+  return rows;
+}
 
-  // parse command line:
-  if (argc == 0) return 1;
-  if (argc == 1 || !strcmp(argv[1], "-h") || !strcmp(argv[1], "--help")) {
-    FILE *out;
-    out = argc == 1 ? stderr : stdout;
-    fprintf(out, "\n");
-    fprintf(out, "Usage: %s <conninfo>\n", argv[0]);
-    fprintf(out, "\n");
-    fprintf(out, "<conninfo> is specified by PostgreSQL's libpq,\n");
-    fprintf(out, "see http://www.postgresql.org/docs/9.6/static/libpq-connect.html\n");
-    fprintf(out, "\n");
-    fprintf(out, "Example: %s dbname=liquid_feedback\n", argv[0]);
-    fprintf(out, "\n");
-    return argc == 1 ? 1 : 0;
-  }
-  {
-    size_t len = 0, seglen;
-    for (i=1; i<argc; i++) {
-      seglen = strlen(argv[i]) + 1;
-      if (seglen >= SIZE_MAX/2 || len >= SIZE_MAX/2) {
-        fprintf(stderr, "Error: Command line arguments too long\n");
-        return 1;
-      }
-      len += seglen;
-    }
-    if (!len) len = 1;  // not needed but suppresses compiler warning
-    conninfo = malloc(len * sizeof(char));
-    if (!conninfo) {
-      fprintf(stderr, "Error: Could not allocate memory for conninfo string\n");
-      return 1;
-    }
-    conninfo[0] = 0;
-    for (i=1; i<argc; i++) {
-      if (i>1) strcat(conninfo, " ");
-      strcat(conninfo, argv[i]);
-    }
+// start a phase, for which statistics are printed or recorded by end_phase(...):
+static void begin_phase(PGconn *db, char *name) {
+  phase_stats.name = name;
+  if (!timing && !metrics_filename) return;
+  phase_stats.rows = rows_written(db);  // not counted as part of the phase
+  phase_stats.db_time = 0;
+  phase_stats.round_trips = 0;
+  clock_gettime(CLOCK_MONOTONIC, &phase_stats.start);
+}
+
+// print statistics of a phase as tab separated line (if enabled): name, wall time, time waiting for the
+// database, number of SQL commands, and rows written (-1 if unknown); and add them to the metrics (if enabled):
+static void end_phase(PGconn *db) {
+  char *name = phase_stats.name;
+  double wall;
+  long long rows;
+  int i;
+  phase_stats.name = "";
+  if (!timing && !metrics_filename) return;
+  wall = seconds_since(&phase_stats.start);
+  rows = rows_written(db);
+  rows = (rows >= 0 && phase_stats.rows >= 0) ? rows - phase_stats.rows : -1;
+  if (timing) printf("%s\t%.6f\t%.6f\t%i\t%lld\n", name, wall, phase_stats.db_time, phase_stats.round_trips, rows);
+  if (!metrics_filename) return;
+  for (i=0; i<phase_metrics_count && strcmp(phase_metrics[i].name, name); i++);
+  if (i == METRICS_MAX_PHASES) return;
+  if (i == phase_metrics_count) {
+    phase_metrics[phase_metrics_count++].name = name;
+  } else if (phase_metrics[i].rows < 0 || rows < 0) {
+    rows = -1;
+  } else {
+    rows += phase_metrics[i].rows;
   }
+  phase_metrics[i].wall_time += wall;
+  phase_metrics[i].db_time += phase_stats.db_time;
+  phase_metrics[i].round_trips += phase_stats.round_trips;
+  phase_metrics[i].rows = rows;
+}
 
-  // connect to database:
-  db = PQconnectdb(conninfo);
-  if (!db) {
-    fprintf(stderr, "Error: Could not create database handle\n");
+// print HELP and TYPE lines of a metric in the text format of the Prometheus node exporter:
+static void metric_header(FILE *out, char *name, char *help) {
+  fprintf(out, "# HELP %s %s\n# TYPE %s gauge\n", name, help, name);
+}
+
+// write metrics of the run in the text format of the Prometheus node exporter ("textfile" collector) to
+// a temporary file, which is then renamed, such that the metrics file is replaced atomically; returns 1
+// on error, otherwise 0:
+static int write_metrics(int err, double duration) {
+  char *tmp_filename;
+  FILE *out;
+  int i;
+  if (asprintf(&tmp_filename, "%s.%i.tmp", metrics_filename, (int)getpid()) < 0) {
+    fprintf(stderr, "Could not prepare filename in memory.\n");
     return 1;
   }
-  if (PQstatus(db) != CONNECTION_OK) {
-    fprintf(stderr, "Could not open connection:\n%s", PQerrorMessage(db));
+  out = fopen(tmp_filename, "w");
+  if (!out) {
+    fprintf(stderr, "Could not create metrics file \"%s\".\n", tmp_filename);
+    free(tmp_filename);
     return 1;
   }
+  metric_header(out, "lf_update_success", "Whether the last run completed without errors");
+  fprintf(out, "lf_update_success %i\n", err ? 0 : 1);
+  metric_header(out, "lf_update_last_run_timestamp_seconds", "Time when the last run finished");
+  fprintf(out, "lf_update_last_run_timestamp_seconds %lld\n", (long long)time(NULL));
+  metric_header(out, "lf_update_duration_seconds", "Wall time of the last run");
+  fprintf(out, "lf_update_duration_seconds %.6f\n", duration);
+  metric_header(out, "lf_update_phase_duration_seconds", "Wall time per phase of the last run");
+  for (i=0; i<phase_metrics_count; i++) fprintf(out, "lf_update_phase_duration_seconds{phase=\"%s\"} %.6f\n", phase_metrics[i].name, phase_metrics[i].wall_time);
+  metric_header(out, "lf_update_phase_database_seconds", "Time spent waiting for the database per phase of the last run");
+  for (i=0; i<phase_metrics_count; i++) fprintf(out, "lf_update_phase_database_seconds{phase=\"%s\"} %.6f\n", phase_metrics[i].name, phase_metrics[i].db_time);
+  metric_header(out, "lf_update_phase_statements", "SQL commands sent per phase of the last run");
+  for (i=0; i<phase_metrics_count; i++) fprintf(out, "lf_update_phase_statements{phase=\"%s\"} %i\n", phase_metrics[i].name, phase_metrics[i].round_trips);
+  metric_header(out, "lf_update_phase_rows_written", "Rows inserted, updated, or deleted in the database per phase of the last run");
+  for (i=0; i<phase_metrics_count; i++) {
+    if (phase_metrics[i].rows >= 0) fprintf(out, "lf_update_phase_rows_written{phase=\"%s\"} %lld\n", phase_metrics[i].name, phase_metrics[i].rows);
+  }
+  metric_header(out, "lf_update_issues_checked", "Open issues checked in the last run");
+  fprintf(out, "lf_update_issues_checked %i\n", metrics.issues_checked);
+  metric_header(out, "lf_update_issue_phases_finished", "Issues which changed their state in the last run");
+  fprintf(out, "lf_update_issue_phases_finished %i\n", metrics.phases_finished);
+  metric_header(out, "lf_update_snapshots_taken", "Snapshots taken in the last run");
+  fprintf(out, "lf_update_snapshots_taken %i\n", metrics.snapshots_taken);
+  metric_header(out, "lf_update_snapshots_reused", "Areas whose latest snapshot has been reused in the last run");
+  fprintf(out, "lf_update_snapshots_reused %i\n", metrics.snapshots_reused);
+  metric_header(out, "lf_update_admission_iterations", "Calls of issue_admission in the last run");
+  fprintf(out, "lf_update_admission_iterations %i\n", metrics.admission_iterations);
+  metric_header(out, "lf_update_retries", "Transactions retried due to lock timeouts, serialization failures, or deadlocks in the last run");
+  fprintf(out, "lf_update_retries %i\n", metrics.retries);
+  if (metrics.ordered) {
+    lf_update_issue_order_write_metrics(out);
+    lf_update_suggestion_order_write_metrics(out);
+  }
+  i = ferror(out);
+  if (fclose(out) || i || rename(tmp_filename, metrics_filename)) {
+    fprintf(stderr, "Could not write metrics file \"%s\".\n", metrics_filename);
+    unlink(tmp_filename);
+    free(tmp_filename);
+    return 1;
+  }
+  free(tmp_filename);
+  return 0;
+}
+
+// kinds of garbage which are deleted in batches by collect_garbage():
+#define GC_EXPIRED_SESSIONS            1
+#define GC_EXPIRED_TOKENS              2
+#define GC_UNUSED_SNAPSHOTS            4
+#define GC_EXPIRED_CONTINGENT_COUNTERS 8
+#define GC_EXPIRED_DATA_CHANGES        16
+#define GC_OBSOLETE_AREA_CHANGES       32
+static struct {
+  int kind;       // one of the GC_... constants above
+  int keyset;     // set to 1 if command continues after the greatest id deleted by the previous batch
+  char *command;  // SQL command deleting one batch in index order, with %i as placeholder for the batch size; if
+                  // keyset is 1, preceded by %lld as placeholder for the greatest id deleted by the previous batch
+                  // (or 0), and returning the number of deleted rows and the greatest deleted id
+} gc_targets[] = {
+  { GC_EXPIRED_SESSIONS, 0, "DELETE FROM \"session\" WHERE \"id\" IN (SELECT \"id\" FROM \"expired_session\" ORDER BY \"expiry\" LIMIT %i)" },
+  { GC_EXPIRED_TOKENS,   0, "DELETE FROM \"token\" WHERE \"id\" IN (SELECT \"id\" FROM \"expired_token\" ORDER BY \"expiry\" LIMIT %i)" },
+  // snapshots which are still used are skipped by every batch, so they are only evaluated once per call of
+  // collect_garbage() by continuing after the last deleted snapshot:
+  { GC_UNUSED_SNAPSHOTS, 1, "WITH \"deleted\" AS (DELETE FROM \"snapshot\" WHERE \"id\" IN (SELECT \"id\" FROM \"unused_snapshot\" WHERE \"id\" > %lld ORDER BY \"id\" LIMIT %i) RETURNING \"id\") SELECT count(1), max(\"id\") FROM \"deleted\"" },
+  { GC_EXPIRED_CONTINGENT_COUNTERS, 0, "DELETE FROM \"member_contingent_counter\" WHERE (\"member_id\", \"polling\", \"bucket\") IN (SELECT \"member_id\", \"polling\", \"bucket\" FROM \"expired_member_contingent_counter\" ORDER BY \"bucket\" LIMIT %i)" },
+  { GC_EXPIRED_DATA_CHANGES, 0, "DELETE FROM \"data_change\" WHERE \"id\" IN (SELECT \"id\" FROM \"expired_data_change\" ORDER BY \"id\" LIMIT %i)" },
+  { GC_OBSOLETE_AREA_CHANGES, 0, "DELETE FROM \"area_change\" WHERE \"id\" IN (SELECT \"id\" FROM \"obsolete_area_change\" ORDER BY \"id\" LIMIT %i)" },
+  { 0, 0, NULL }
+};
+#define GC_TARGET_COUNT (sizeof(gc_targets) / sizeof(gc_targets[0]))
+
+// budget limiting the work done by collect_garbage():
+struct gc_budget {
+  int batch_size;         // maximum number of rows deleted per transaction
+  int max_rows;           // maximum number of rows deleted in total
+  int max_time;           // maximum number of seconds spent in total
+  int rows;               // number of rows deleted so far
+  struct timespec start;  // time when garbage collection has been started
+};
+
+// delete garbage of the given kinds in batches, where each batch is a separate transaction;
+// kinds are processed in turns, such that a large backlog of one kind does not starve the others;
+// returns 1 if the budget has been exhausted before all garbage was deleted, otherwise 0:
+static int collect_garbage(PGconn *db, int *errptr, int kinds, struct gc_budget *budget) {
+  int i, limit, deleted, len;
+  long long last_ids[GC_TARGET_COUNT] = { 0 };  // greatest id deleted so far (for targets with keyset set)
+  char *cmd;
+  PGresult *res;
+  while (kinds) {
+    for (i=0; gc_targets[i].kind; i++) {
+      if (!(kinds & gc_targets[i].kind)) continue;
+      if (budget->rows >= budget->max_rows || seconds_since(&budget->start) >= budget->max_time) return 1;
+      limit = budget->max_rows - budget->rows;
+      if (limit > budget->batch_size) limit = budget->batch_size;
+      if (gc_targets[i].keyset) len = asprintf(&cmd, gc_targets[i].command, last_ids[i], limit);
+      else len = asprintf(&cmd, gc_targets[i].command, limit);
+      if (len < 0) {
+        fprintf(stderr, "Could not prepare query string in memory.\n");
+        if (errptr) *errptr = 1;
+        return 0;
+      }
+      if (gc_targets[i].keyset) {
+        deleted = -1;
+        exec_sql(db, &res, errptr, 1, cmd);
+        if (res) {
+          deleted = atoi(PQgetvalue(res, 0, 0));
+          if (deleted > 0) last_ids[i] = atoll(PQgetvalue(res, 0, 1));
+          PQclear(res);
+        }
+      } else {
+        deleted = exec_sql(db, NULL, errptr, 0, cmd);
+      }
+      free(cmd);
+      if (deleted < limit) kinds &= ~gc_targets[i].kind;  // done (or failed) for this kind
+      if (deleted > 0) budget->rows += deleted;
+    }
+  }
+  return 0;
+}
+
+// report remaining garbage, to be called when collect_garbage() ran out of budget:
+static void report_garbage_backlog(PGconn *db, int *errptr) {
+  PGresult *res;
+  exec_sql(db, &res, errptr, 1, "SELECT \"expired_session_count\", \"expired_token_count\", \"unused_snapshot_count\", \"expired_member_contingent_counter_count\", \"expired_data_change_count\", \"obsolete_area_change_count\" FROM \"garbage_collection_backlog\"");
+  if (!res) return;
+  fprintf(stderr,
+    "Notice: Garbage collection budget exhausted; %s expired sessions, %s expired tokens, %s unused snapshots, %s expired contingent counters, %s expired data changes, and %s obsolete area changes are left for the next run.\n",
+    PQgetvalue(res, 0, 0), PQgetvalue(res, 0, 1), PQgetvalue(res, 0, 2), PQgetvalue(res, 0, 3), PQgetvalue(res, 0, 4), PQgetvalue(res, 0, 5)
+  );
+  PQclear(res);
+}
+
+// run time limit (see command line option "--max-run-time"):
+static int max_run_time = 0;        // seconds after which no further work is started (0 = unlimited)
+static struct timespec run_start;   // time when lf_update was started
+static int deadline_reached = 0;    // set to 1 if remaining work was skipped due to max_run_time
+
+// check if no further work should be started:
+static int deadline_passed() {
+  if (max_run_time && seconds_since(&run_start) >= max_run_time) deadline_reached = 1;
+  return deadline_reached;
+}
 
-  // delete expired sessions:
-  exec_sql(db, NULL, &err, 0, "DELETE FROM \"expired_session\"");
+// prefix for commands whose transaction cannot be split into smaller portions (e.g. taking a snapshot of
+// an area, or closing the voting of an issue), such that they would fail again in every run if they took
+// longer than the statement timeout (see command line option "--statement-timeout"):
+#define NO_STATEMENT_TIMEOUT "SET LOCAL \"statement_timeout\" = 0; "
 
-  // delete expired tokens and authorization codes:
-  exec_sql(db, NULL, &err, 0, "DELETE FROM \"expired_token\"");
- 
-  // delete unused snapshots:
-  exec_sql(db, NULL, &err, 0, "DELETE FROM \"unused_snapshot\"");
- 
-  // check member activity:
-  exec_sql(db, NULL, &err, 0, "SET TRANSACTION ISOLATION LEVEL READ COMMITTED; SELECT \"check_activity\"()");
+// class of advisory locks used to claim shards (first key of pg_try_advisory_lock(int4, int4)),
+// which is 'lfup' in ASCII; the second key is the shard number or SHARD_GLOBAL:
+#define SHARD_LOCK_CLASS  0x6c667570
+#define SHARD_GLOBAL      -1  // shard for global tasks (garbage collection, member activity and counts, newsletters)
 
-  // calculate member counts:
-  exec_sql(db, NULL, &err, 0, "SET TRANSACTION ISOLATION LEVEL REPEATABLE READ; SELECT \"calculate_member_counts\"()");
+// class of advisory locks used by parallel jobs to claim issues (see check_issues_parallel()),
+// which is 'lfis' in ASCII; the second key is the issue id:
+#define ISSUE_LOCK_CLASS  0x6c666973
+
+// claim a shard or an issue through a session-level advisory lock, which is held until the connection is
+// closed (i.e. automatically released if the claiming process dies); returns 1 on success, otherwise 0:
+static int claim(PGconn *db, int *errptr, int lock_class, int key) {
+  PGresult *res;
+  char *cmd;
+  int claimed;
+  if (asprintf(&cmd, "SELECT pg_try_advisory_lock(%i, %i)", lock_class, key) < 0) {
+    fprintf(stderr, "Could not prepare query string in memory.\n");
+    if (errptr) *errptr = 1;
+    return 0;
+  }
+  exec_sql(db, &res, errptr, 1, cmd);
+  free(cmd);
+  if (!res) return 0;
+  claimed = PQgetvalue(res, 0, 0)[0] == 't';
+  PQclear(res);
+  return claimed;
+}
 
-  // issue admission:
-  count = exec_sql(db, &res, &err, 0, "SET TRANSACTION ISOLATION LEVEL READ COMMITTED; SELECT \"id\" FROM \"area_with_unaccepted_issues\"");
-  if (!res) admission_failed = 1;
-  else {
-    char *area_id, *escaped_area_id, *cmd;
+// take snapshots and perform issue admission for all areas of a shard (where "id" modulo shard_count equals shard);
+// returns 1 if admission failed or has been skipped for any area, otherwise 0:
+static int admit_issues(PGconn *db, int *errptr, int shard_count, int shard) {
+  int admission_failed = 0;  /* set to 1 if error occurred during admission */
+  int i, count;
+  char *cmd;
+  PGresult *res;
+  if (asprintf(&cmd, "SET TRANSACTION ISOLATION LEVEL READ COMMITTED; SELECT \"id\" FROM \"area_with_unaccepted_issues\" WHERE \"id\" %% %i = %i", shard_count, shard) < 0) {
+    fprintf(stderr, "Could not prepare query string in memory.\n");
+    if (errptr) *errptr = 1;
+    return 1;
+  }
+  count = exec_sql(db, &res, errptr, 0, cmd);
+  free(cmd);
+  if (!res) return 1;
+  {
+    char *area_id, *escaped_area_id;
     PGresult *res2;
     for (i=0; i<count; i++) {
+      if (deadline_passed()) {
+        admission_failed = 1;
+        break;
+      }
       area_id = PQgetvalue(res, i, 0);
+      snprintf(slow_log_object, sizeof(slow_log_object), "area #%s", area_id);
       escaped_area_id = PQescapeLiteral(db, area_id, strlen(area_id));
       if (!escaped_area_id) {
         fprintf(stderr, "Could not escape literal in memory.\n");
-        err = admission_failed = 1;
+        *errptr = admission_failed = 1;
         continue;
       }
-      if (asprintf(&cmd, "SET TRANSACTION ISOLATION LEVEL REPEATABLE READ; SELECT \"take_snapshot\"(NULL, %s)", escaped_area_id) < 0) {
+      if (asprintf(&cmd, "SET TRANSACTION ISOLATION LEVEL REPEATABLE READ; " NO_STATEMENT_TIMEOUT "SELECT \"take_snapshot\"(NULL, %s)", escaped_area_id) < 0) {
         fprintf(stderr, "Could not prepare query string in memory.\n");
-        err = admission_failed = 1;
+        *errptr = admission_failed = 1;
         PQfreemem(escaped_area_id);
         continue;
       }
-      exec_sql(db, &res2, &err, 1, cmd);
+      exec_sql(db, &res2, errptr, 1, cmd);
       free(cmd);
       if (!res2) admission_failed = 1;
       else {
         char *snapshot_id, *escaped_snapshot_id;
         int j, count2;
+        if (PQgetisnull(res2, 0, 0)) {
+          // latest snapshot of area is still up to date and does not need to be finished:
+          metrics.snapshots_reused++;
+          PQclear(res2);
+          goto area_admission;
+        }
+        metrics.snapshots_taken++;
         snapshot_id = PQgetvalue(res2, 0, 0);
         escaped_snapshot_id = PQescapeLiteral(db, snapshot_id, strlen(snapshot_id));
         PQclear(res2);
         if (!escaped_snapshot_id) {
           fprintf(stderr, "Could not escape literal in memory.\n");
-          err = admission_failed = 1;
+          *errptr = admission_failed = 1;
           goto area_admission_cleanup;
         }
         if (asprintf(&cmd, "SET TRANSACTION ISOLATION LEVEL READ COMMITTED; SELECT \"issue_id\" FROM \"snapshot_issue\" WHERE \"snapshot_id\" = %s", escaped_snapshot_id) < 0) {
           fprintf(stderr, "Could not prepare query string in memory.\n");
-          err = admission_failed = 1;
+          *errptr = admission_failed = 1;
           PQfreemem(escaped_snapshot_id);
           goto area_admission_cleanup;
         }
-        PQfreemem(escaped_snapshot_id);
-        count2 = exec_sql(db, &res2, &err, 0, cmd);
+        count2 = exec_sql(db, &res2, errptr, 0, cmd);
         free(cmd);
         if (!res2) admission_failed = 1;
         else {
@@ -166,30 +574,34 @@ int main(int argc, char **argv) {
             escaped_issue_id = PQescapeLiteral(db, issue_id, strlen(issue_id));
             if (!escaped_issue_id) {
               fprintf(stderr, "Could not escape literal in memory.\n");
-              err = admission_failed = 1;
+              *errptr = admission_failed = 1;
               continue;
             }
-            if (asprintf(&cmd, "SET TRANSACTION ISOLATION LEVEL READ COMMITTED; SELECT \"finish_snapshot\"(%s)", escaped_issue_id) < 0) {
+            // the snapshot id is passed explicitly, as other processes (see option "--shards") may have taken
+            // further snapshots in the meantime:
+            if (asprintf(&cmd, "SET TRANSACTION ISOLATION LEVEL READ COMMITTED; " NO_STATEMENT_TIMEOUT "SELECT \"finish_snapshot\"(%s, %s)", escaped_issue_id, escaped_snapshot_id) < 0) {
               fprintf(stderr, "Could not prepare query string in memory.\n");
-              err = admission_failed = 1;
+              *errptr = admission_failed = 1;
               PQfreemem(escaped_issue_id);
               continue;
             }
             PQfreemem(escaped_issue_id);
-            if (exec_sql(db, NULL, &err, 0, cmd) < 0) admission_failed = 1;
+            if (exec_sql(db, NULL, errptr, 0, cmd) < 0) admission_failed = 1;
             free(cmd);
           }
           PQclear(res2);
         }
-        if (!admission_failed) {
-          if (asprintf(&cmd, "SET TRANSACTION ISOLATION LEVEL READ COMMITTED; SELECT \"issue_admission\"(%s)", escaped_area_id) < 0) {
-            fprintf(stderr, "Could not prepare query string in memory.\n");
-            err = admission_failed = 1;
-            goto area_admission_cleanup;
-          }
+        PQfreemem(escaped_snapshot_id);
+        area_admission:
+        if (admission_failed) goto area_admission_cleanup;
+        if (asprintf(&cmd, "SET TRANSACTION ISOLATION LEVEL READ COMMITTED; " NO_STATEMENT_TIMEOUT "SELECT \"issue_admission\"(%s)", escaped_area_id) < 0) {
+          fprintf(stderr, "Could not prepare query string in memory.\n");
+          *errptr = admission_failed = 1;
+          goto area_admission_cleanup;
         }
         while (1) {
-          exec_sql(db, &res2, &err, 1, cmd);
+          metrics.admission_iterations++;
+          exec_sql(db, &res2, errptr, 1, cmd);
           if (!res2) {
             admission_failed = 1;
             break;
@@ -200,83 +612,512 @@ int main(int argc, char **argv) {
           }
           PQclear(res2);
         }
+        free(cmd);
       }
       area_admission_cleanup:
       PQfreemem(escaped_area_id);
     }
-    PQclear(res);
   }
+  PQclear(res);
+  slow_log_object[0] = 0;
+  return admission_failed;
+}
 
-  // update open issues:
-  count = exec_sql(
-    db, &res, &err, 0,
-    admission_failed ?
-    "SELECT \"id\" FROM \"open_issue\" WHERE \"state\" != 'admission'::\"issue_state\"" :
-    "SELECT \"id\" FROM \"open_issue\""
-  );
-  for (i=0; i<count; i++) {
-    char *issue_id, *escaped_issue_id;
-    PGresult *res2, *old_res2;
-    int j;
-    issue_id = PQgetvalue(res, i, 0);
-    escaped_issue_id = PQescapeLiteral(db, issue_id, strlen(issue_id));
-    if (!escaped_issue_id) {
-      fprintf(stderr, "Could not escape literal in memory.\n");
-      err = 1;
-      continue;
+// check if a field of a "check_issue_persistence" value in text representation, e.g. "(admission,t,f,t,f,f)",
+// is true, where field 0 is the state:
+static int persistence_flag(char *persist, int field) {
+  for (; *persist && field; persist++) if (*persist == ',') field--;
+  return *persist == 't';
+}
+
+// call "check_issue"(...) for a single issue repeatedly, until it returns NULL:
+static void check_issue(PGconn *db, int *errptr, char *issue_id) {
+  char *escaped_issue_id;
+  PGresult *res2, *old_res2;
+  int j;
+  int phase_finished = 0, snapshot_created = 0;  // flags of returned persistence values (for metrics)
+  snprintf(slow_log_object, sizeof(slow_log_object), "issue #%s", issue_id);
+  escaped_issue_id = PQescapeLiteral(db, issue_id, strlen(issue_id));
+  if (!escaped_issue_id) {
+    fprintf(stderr, "Could not escape literal in memory.\n");
+    *errptr = 1;
+    return;
+  }
+  old_res2 = NULL;
+  for (j=0; ; j++) {
+    if (j >= 20) {  // safety to avoid endless loops
+      fprintf(stderr, "Function \"check_issue\"(...) returned non-null value too often.\n");
+      *errptr = 1;
+      if (j > 0) PQclear(old_res2);
+      break;
     }
-    old_res2 = NULL;
-    for (j=0; ; j++) {
-      if (j >= 20) {  // safety to avoid endless loops
-        fprintf(stderr, "Function \"check_issue\"(...) returned non-null value too often.\n");
-        err = 1;
-        if (j > 0) PQclear(old_res2);
+    if (j == 0) {
+      char *cmd;
+      if (asprintf(&cmd, "SET TRANSACTION ISOLATION LEVEL REPEATABLE READ; " NO_STATEMENT_TIMEOUT "SELECT \"check_issue\"(%s, NULL)", escaped_issue_id) < 0) {
+        fprintf(stderr, "Could not prepare query string in memory.\n");
+        *errptr = 1;
         break;
       }
-      if (j == 0) {
-        char *cmd;
-        if (asprintf(&cmd, "SET TRANSACTION ISOLATION LEVEL REPEATABLE READ; SELECT \"check_issue\"(%s, NULL)", escaped_issue_id) < 0) {
-          fprintf(stderr, "Could not prepare query string in memory.\n");
-          err = 1;
-          break;
-        }
-        exec_sql(db, &res2, &err, 1, cmd);
-        free(cmd);
-      } else {
-        char *persist, *escaped_persist, *cmd;
-        persist = PQgetvalue(old_res2, 0, 0);
-        escaped_persist = PQescapeLiteral(db, persist, strlen(persist));
-        if (!escaped_persist) {
-          fprintf(stderr, "Could not escape literal in memory.\n");
-          err = 1;
-          PQclear(old_res2);
-          break;
-        }
-        if (asprintf(&cmd, "SET TRANSACTION ISOLATION LEVEL REPEATABLE READ; SELECT \"check_issue\"(%s, %s::\"check_issue_persistence\")", escaped_issue_id, escaped_persist) < 0) {
-          PQfreemem(escaped_persist);
-          fprintf(stderr, "Could not prepare query string in memory.\n");
-          err = 1;
-          PQclear(old_res2);
-          break;
-        }
-        PQfreemem(escaped_persist);
-        exec_sql(db, &res2, &err, 1, cmd);
-        free(cmd);
+      exec_sql(db, &res2, errptr, 1, cmd);
+      free(cmd);
+    } else {
+      char *persist, *escaped_persist, *cmd;
+      persist = PQgetvalue(old_res2, 0, 0);
+      escaped_persist = PQescapeLiteral(db, persist, strlen(persist));
+      if (!escaped_persist) {
+        fprintf(stderr, "Could not escape literal in memory.\n");
+        *errptr = 1;
         PQclear(old_res2);
+        break;
       }
-      if (!res2) break;
-      if (PQgetisnull(res2, 0, 0)) {
-        PQclear(res2);
+      if (asprintf(&cmd, "SET TRANSACTION ISOLATION LEVEL REPEATABLE READ; " NO_STATEMENT_TIMEOUT "SELECT \"check_issue\"(%s, %s::\"check_issue_persistence\")", escaped_issue_id, escaped_persist) < 0) {
+        PQfreemem(escaped_persist);
+        fprintf(stderr, "Could not prepare query string in memory.\n");
+        *errptr = 1;
+        PQclear(old_res2);
         break;
       }
-      old_res2 = res2;
+      PQfreemem(escaped_persist);
+      exec_sql(db, &res2, errptr, 1, cmd);
+      free(cmd);
+      PQclear(old_res2);
+    }
+    if (!res2) break;
+    if (PQgetisnull(res2, 0, 0)) {
+      PQclear(res2);
+      break;
+    }
+    {
+      char *persist = PQgetvalue(res2, 0, 0);
+      // state changes if phase is finished or issue is revoked; no snapshot is taken in admission state:
+      if (persistence_flag(persist, 1) || persistence_flag(persist, 2)) phase_finished = 1;
+      if (persistence_flag(persist, 3) && strncmp(persist, "(admission,", 11)) snapshot_created = 1;
     }
-    PQfreemem(escaped_issue_id);
+    old_res2 = res2;
   }
-  if (res) PQclear(res);
+  PQfreemem(escaped_issue_id);
+  slow_log_object[0] = 0;
+  metrics.issues_checked++;
+  metrics.phases_finished += phase_finished;
+  metrics.snapshots_taken += snapshot_created;
+}
+
+// parallel jobs for issues whose voting has ended (see command line option "--jobs"):
+static int jobs = 1;                   // number of connections used in parallel
+static char *conninfo = NULL;          // conninfo for connections of parallel jobs
+static char *session_settings = NULL;  // SQL command applied to every connection (lock and statement timeout)
+
+// counters of a parallel job, which are reported to the main process through a pipe:
+struct job_report {
+  double db_time;
+  int round_trips;
+  int issues_checked;
+  int phases_finished;
+  int snapshots_taken;
+  int retries;
+};
+
+// check issues given by the first count rows of res on a new connection, where every issue is claimed through
+// an advisory lock first, such that each issue is only checked by one job; counters are written to fd; returns
+// the exit code of the job process:
+static int check_issues_job(PGresult *res, int count, int fd) {
+  int err = 0;
+  int i;
+  PGconn *db;
+  struct job_report report;
+  // only count work done by this job:
+  phase_stats.db_time = 0;
+  phase_stats.round_trips = 0;
+  memset(&metrics, 0, sizeof(metrics));
+  db = PQconnectdb(conninfo);
+  if (!db || PQstatus(db) != CONNECTION_OK) {
+    fprintf(stderr, "Could not open connection for parallel job:\n%s", db ? PQerrorMessage(db) : "out of memory\n");
+    err = 1;
+  } else if (!session_settings || exec_sql(db, NULL, &err, 0, session_settings) >= 0) {
+    for (i=0; i<count; i++) {
+      char *issue_id = PQgetvalue(res, i, 0);
+      if (deadline_passed()) break;
+      if (claim(db, &err, ISSUE_LOCK_CLASS, atoi(issue_id))) check_issue(db, &err, issue_id);
+    }
+  }
+  PQfinish(db);
+  report.db_time = phase_stats.db_time;
+  report.round_trips = phase_stats.round_trips;
+  report.issues_checked = metrics.issues_checked;
+  report.phases_finished = metrics.phases_finished;
+  report.snapshots_taken = metrics.snapshots_taken;
+  report.retries = metrics.retries;
+  if (write(fd, &report, sizeof(report)) != sizeof(report)) err = 1;
+  close(fd);
+  return err;
+}
+
+// check issues given by the first count rows of res using up to "jobs" processes with separate connections,
+// such that the time until all results are published is bounded by the largest issue rather than by the sum
+// of all issues (used for issues whose voting has ended, as "close_voting" and "calculate_ranks" take most of
+// the time); falls back to checking the issues sequentially on db if no process can be started:
+static void check_issues_parallel(PGconn *db, int *errptr, PGresult *res, int count) {
+  int job_count = jobs < count ? jobs : count;
+  pid_t *pids;
+  int *fds;
+  int i, started;
+  pids = malloc(job_count * sizeof(pid_t));
+  fds = malloc(job_count * sizeof(int));
+  if (!pids || !fds) {
+    fprintf(stderr, "Could not allocate memory for parallel jobs.\n");
+    abort();
+  }
+  fflush(stdout);
+  fflush(stderr);
+  for (started=0; started<job_count; started++) {
+    int pipefds[2];
+    if (pipe(pipefds)) break;
+    pids[started] = fork();
+    if (pids[started] < 0) {
+      close(pipefds[0]);
+      close(pipefds[1]);
+      break;
+    }
+    if (pids[started] == 0) {
+      close(pipefds[0]);
+      _exit(check_issues_job(res, count, pipefds[1]));
+    }
+    close(pipefds[1]);
+    fds[started] = pipefds[0];
+  }
+  if (!started) {
+    fprintf(stderr, "Could not start parallel jobs, checking issues sequentially.\n");
+    for (i=0; i<count; i++) {
+      if (deadline_passed()) break;
+      check_issue(db, errptr, PQgetvalue(res, i, 0));
+    }
+  }
+  for (i=0; i<started; i++) {
+    struct job_report report;
+    int status;
+    if (read(fds[i], &report, sizeof(report)) == sizeof(report)) {
+      phase_stats.db_time += report.db_time;
+      phase_stats.round_trips += report.round_trips;
+      metrics.issues_checked += report.issues_checked;
+      metrics.phases_finished += report.phases_finished;
+      metrics.snapshots_taken += report.snapshots_taken;
+      metrics.retries += report.retries;
+    }
+    close(fds[i]);
+    if (waitpid(pids[i], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status)) {
+      fprintf(stderr, "Parallel job checking issues failed.\n");
+      *errptr = 1;
+    }
+  }
+  // issues which have not been claimed due to failed jobs are checked in the next run:
+  free(pids);
+  free(fds);
+}
+
+// update all open issues of a shard (where "area_id" modulo shard_count equals shard),
+// skipping issues in admission state if admission failed; issues are checked in the order
+// of their priority (see below):
+static void check_issues(PGconn *db, int *errptr, int shard_count, int shard, int admission_failed) {
+  int i, count, urgent = 0, pending = 0, offset = 0;
+  char *cmd;
+  PGresult *res;
+  // priority 0: voting has ended (results have to be calculated and published),
+  // priority 1: any other phase has ended, or calculations of a finished phase are pending,
+  // priority 2: all other issues (usually no changes):
+  if (asprintf(
+    &cmd,
+    "SELECT \"id\", CASE"
+    " WHEN \"state\" = 'voting'::\"issue_state\" AND (\"phase_finished\" NOTNULL OR \"fully_frozen\" + \"voting_time\" <= now()) THEN 0"
+    " WHEN \"phase_finished\" NOTNULL"
+    " OR (\"state\" = 'admission'::\"issue_state\" AND \"created\" + \"max_admission_time\" <= now())"
+    " OR (\"state\" = 'discussion'::\"issue_state\" AND \"accepted\" + \"discussion_time\" <= now())"
+    " OR (\"state\" = 'verification'::\"issue_state\" AND \"half_frozen\" + \"verification_time\" <= now()) THEN 1"
+    " ELSE 2 END AS \"priority\""
+    " FROM \"open_issue\" WHERE \"area_id\" %% %i = %i%s ORDER BY \"priority\", \"id\"",
+    shard_count, shard,
+    admission_failed ? " AND \"state\" != 'admission'::\"issue_state\"" : ""
+  ) < 0) {
+    fprintf(stderr, "Could not prepare query string in memory.\n");
+    *errptr = 1;
+    return;
+  }
+  count = exec_sql(db, &res, errptr, 0, cmd);
+  free(cmd);
+  if (!res) return;
+  while (urgent < count && PQgetvalue(res, urgent, 1)[0] == '0') urgent++;
+  while (urgent + pending < count && PQgetvalue(res, urgent + pending, 1)[0] == '1') pending++;
+  // issues whose voting has ended (in parallel, if enabled):
+  if (jobs > 1 && urgent > 1) {
+    check_issues_parallel(db, errptr, res, urgent);
+  } else {
+    for (i=0; i<urgent; i++) {
+      if (deadline_passed()) break;
+      check_issue(db, errptr, PQgetvalue(res, i, 0));
+    }
+  }
+  // issues whose phase has ended:
+  for (i=urgent; i<urgent+pending; i++) {
+    if (deadline_passed()) break;
+    check_issue(db, errptr, PQgetvalue(res, i, 0));
+  }
+  // all other issues; when run time is limited, start at a random position to not always skip the same issues:
+  count -= urgent + pending;
+  if (max_run_time && count > 0) {
+    srand(time(NULL));
+    offset = rand() % count;
+  }
+  for (i=0; i<count; i++) {
+    if (deadline_passed()) break;
+    check_issue(db, errptr, PQgetvalue(res, urgent + pending + (offset + i) % count, 0));
+  }
+  PQclear(res);
+}
+
+int main(int argc, char **argv) {
+
+  // variable declarations:
+  int err = 0;                /* set to 1 if any error occured */
+  int gc_backlog = 0;         /* set to 1 if garbage is left for next run */
+  int lock_timeout = 0;       /* lock_timeout in milliseconds (0 = server default) */
+  int statement_timeout = 0;  /* statement_timeout in milliseconds (0 = server default) */
+  int shard_count = 1;        /* number of shards, when work is shared among several processes */
+  int first_shard = 0;        /* shard to be claimed first, counting from 1 (0 = chosen by process id) */
+  int global_tasks = 1;       /* set to 0 if global tasks are performed by another process */
+  int cycle = 0;              /* set to 1 if issues and suggestions are ordered as well */
+  int i;
+  int argb;                   /* index of first command line argument belonging to conninfo */
+  struct gc_budget gc_budget = { GC_DEFAULT_BATCH_SIZE, GC_DEFAULT_MAX_ROWS, GC_DEFAULT_MAX_TIME, };
+  PGconn *db;
+
+  // parse command line:
+  if (argc == 0) return 1;
+  if (argc == 1 || !strcmp(argv[1], "-h") || !strcmp(argv[1], "--help")) {
+    FILE *out;
+    out = argc == 1 ? stderr : stdout;
+    fprintf(out, "\n");
+    fprintf(out, "Usage: %s [options] <conninfo>\n", argv[0]);
+    fprintf(out, "\n");
+    fprintf(out, "Options:\n");
+    fprintf(out, "  --gc-batch-size <rows>   rows deleted per transaction by garbage collection (default %i)\n", GC_DEFAULT_BATCH_SIZE);
+    fprintf(out, "  --gc-max-rows <rows>     rows deleted per run by garbage collection (default %i)\n", GC_DEFAULT_MAX_ROWS);
+    fprintf(out, "  --gc-max-time <seconds>  time spent per run on garbage collection (default %i)\n", GC_DEFAULT_MAX_TIME);
+    fprintf(out, "  --lock-timeout <ms>      give up waiting for locks after given time, and retry later\n");
+    fprintf(out, "  --statement-timeout <ms> abort (and roll back) transactions running longer, except\n");
+    fprintf(out, "                           for those which cannot be split (snapshots, admission, issue\n");
+    fprintf(out, "                           checks, member activity and counts, newsletter recipients,\n");
+    fprintf(out, "                           and ordering); i.e. limits garbage collection batches\n");
+    fprintf(out, "  --max-run-time <seconds> do not start further work after given time; remaining\n");
+    fprintf(out, "                           work is done in the next run\n");
+    fprintf(out, "  --shards <count>         share work among several processes (possibly on different\n");
+    fprintf(out, "                           hosts) by splitting areas into the given number of shards\n");
+    fprintf(out, "  --shard <number>         shard (from 1 to <count>) to claim first; shards which have\n");
+    fprintf(out, "                           not been claimed by other processes are processed afterwards\n");
+    fprintf(out, "  --jobs <count>           check issues whose voting has ended on up to the given number\n");
+    fprintf(out, "                           of connections in parallel (default 1)\n");
+    fprintf(out, "  --cycle                  also calculate the ordering of issues and suggestions (like\n");
+    fprintf(out, "                           lf_update_issue_order and lf_update_suggestion_order) on\n");
+    fprintf(out, "                           the same connection after checking all issues\n");
+    fprintf(out, "  --timing                 print wall time, time spent waiting for the database, number\n");
+    fprintf(out, "                           of SQL commands, and number of rows written for each phase\n");
+    fprintf(out, "                           as tab separated lines to stdout (used by lf_bench)\n");
+    fprintf(out, "  --metrics <file>         write metrics of each run to given file, using the text format\n");
+    fprintf(out, "                           of the Prometheus node exporter (textfile collector)\n");
+    fprintf(out, "  --slow-log <file>        append SQL commands taking longer than the slow threshold to\n");
+    fprintf(out, "                           given file, together with their plans (determined by executing\n");
+    fprintf(out, "                           them again in a transaction which is rolled back)\n");
+    fprintf(out, "  --slow-threshold <ms>    threshold for --slow-log (default %i)\n", SLOW_LOG_DEFAULT_THRESHOLD);
+    fprintf(out, "\n");
+    fprintf(out, "<conninfo> is specified by PostgreSQL's libpq,\n");
+    fprintf(out, "see http://www.postgresql.org/docs/9.6/static/libpq-connect.html\n");
+    fprintf(out, "\n");
+    fprintf(out, "Example: %s dbname=liquid_feedback\n", argv[0]);
+    fprintf(out, "\n");
+    return argc == 1 ? 1 : 0;
+  }
+  for (argb=1; argb<argc && argv[argb][0] == '-'; argb++) {
+    int *option_value;
+    char *endptr;
+    if (!strcmp(argv[argb], "--timing")) {
+      timing = 1;
+      continue;
+    }
+    if (!strcmp(argv[argb], "--cycle")) {
+      cycle = 1;
+      continue;
+    }
+    if (!strcmp(argv[argb], "--metrics") || !strcmp(argv[argb], "--slow-log")) {
+      if (++argb >= argc) {
+        fprintf(stderr, "Error: Option \"%s\" requires an argument\n", argv[argb-1]);
+        return 1;
+      }
+      if (!strcmp(argv[argb-1], "--metrics")) metrics_filename = argv[argb];
+      else slow_log_filename = argv[argb];
+      continue;
+    }
+    if      (!strcmp(argv[argb], "--gc-batch-size")) option_value = &gc_budget.batch_size;
+    else if (!strcmp(argv[argb], "--gc-max-rows"))   option_value = &gc_budget.max_rows;
+    else if (!strcmp(argv[argb], "--gc-max-time"))   option_value = &gc_budget.max_time;
+    else if (!strcmp(argv[argb], "--lock-timeout"))  option_value = &lock_timeout;
+    else if (!strcmp(argv[argb], "--statement-timeout")) option_value = &statement_timeout;
+    else if (!strcmp(argv[argb], "--max-run-time"))  option_value = &max_run_time;
+    else if (!strcmp(argv[argb], "--shards"))        option_value = &shard_count;
+    else if (!strcmp(argv[argb], "--shard"))         option_value = &first_shard;
+    else if (!strcmp(argv[argb], "--jobs"))          option_value = &jobs;
+    else if (!strcmp(argv[argb], "--slow-threshold")) option_value = &slow_log_threshold;
+    else {
+      fprintf(stderr, "Error: Unknown option \"%s\"\n", argv[argb]);
+      return 1;
+    }
+    if (++argb >= argc) {
+      fprintf(stderr, "Error: Option \"%s\" requires an argument\n", argv[argb-1]);
+      return 1;
+    }
+    *option_value = (int)strtol(argv[argb], &endptr, 10);
+    if (!argv[argb][0] || *endptr || *option_value <= 0) {
+      fprintf(stderr, "Error: Option \"%s\" requires a positive integer as argument\n", argv[argb-1]);
+      return 1;
+    }
+  }
+  if (argb >= argc) {
+    fprintf(stderr, "Error: No conninfo given\n");
+    return 1;
+  }
+  if (first_shard > shard_count) {
+    fprintf(stderr, "Error: Shard number must not be greater than shard count\n");
+    return 1;
+  }
+  first_shard = first_shard ? first_shard - 1 : getpid() % shard_count;
+  {
+    size_t len = 0, seglen;
+    for (i=argb; i<argc; i++) {
+      seglen = strlen(argv[i]) + 1;
+      if (seglen >= SIZE_MAX/2 || len >= SIZE_MAX/2) {
+        fprintf(stderr, "Error: Command line arguments too long\n");
+        return 1;
+      }
+      len += seglen;
+    }
+    if (!len) len = 1;  // not needed but suppresses compiler warning
+    conninfo = malloc(len * sizeof(char));
+    if (!conninfo) {
+      fprintf(stderr, "Error: Could not allocate memory for conninfo string\n");
+      return 1;
+    }
+    conninfo[0] = 0;
+    for (i=argb; i<argc; i++) {
+      if (i>argb) strcat(conninfo, " ");
+      strcat(conninfo, argv[i]);
+    }
+  }
+
+  // remember start time to be able to stop in time:
+  clock_gettime(CLOCK_MONOTONIC, &run_start);
+
+  // connect to database:
+  db = PQconnectdb(conninfo);
+  if (!db) {
+    fprintf(stderr, "Error: Could not create database handle\n");
+    return 1;
+  }
+  if (PQstatus(db) != CONNECTION_OK) {
+    fprintf(stderr, "Could not open connection:\n%s", PQerrorMessage(db));
+    if (metrics_filename) write_metrics(1, seconds_since(&run_start));
+    return 1;
+  }
+
+  // limit time spent waiting for locks and time spent in a single transaction:
+  if (lock_timeout || statement_timeout) {
+    if (asprintf(&session_settings, "SET \"lock_timeout\" = %i; SET \"statement_timeout\" = %i", lock_timeout, statement_timeout) < 0) {
+      fprintf(stderr, "Could not prepare query string in memory.\n");
+      return 1;
+    }
+    if (exec_sql(db, NULL, &err, 0, session_settings) < 0) {
+      PQfinish(db);
+      return 1;
+    }
+  }
+
+  // when work is shared, only one process performs the global tasks:
+  if (shard_count > 1) global_tasks = claim(db, &err, SHARD_LOCK_CLASS, SHARD_GLOBAL);
+
+  if (global_tasks) {
+
+    // delete expired sessions, expired tokens and authorization codes, and unused snapshots:
+    begin_phase(db, "collect_garbage");
+    clock_gettime(CLOCK_MONOTONIC, &gc_budget.start);
+    gc_budget.rows = 0;
+    if (collect_garbage(db, &err, GC_EXPIRED_SESSIONS | GC_EXPIRED_TOKENS | GC_UNUSED_SNAPSHOTS | GC_EXPIRED_CONTINGENT_COUNTERS | GC_EXPIRED_DATA_CHANGES | GC_OBSOLETE_AREA_CHANGES, &gc_budget)) gc_backlog = 1;
+    end_phase(db);
+
+    // create partitions of event table for the current and the next month:
+    begin_phase(db, "create_event_partitions");
+    exec_sql(db, NULL, &err, 0, "SET TRANSACTION ISOLATION LEVEL READ COMMITTED; SELECT \"create_event_partitions\"()");
+    end_phase(db);
+
+    // check member activity:
+    begin_phase(db, "check_activity");
+    exec_sql(db, NULL, &err, 0, "SET TRANSACTION ISOLATION LEVEL READ COMMITTED; " NO_STATEMENT_TIMEOUT "SELECT \"check_activity\"()");
+    end_phase(db);
+
+    // calculate member counts:
+    begin_phase(db, "calculate_member_counts");
+    exec_sql(db, NULL, &err, 0, "SET TRANSACTION ISOLATION LEVEL REPEATABLE READ; " NO_STATEMENT_TIMEOUT "SELECT \"calculate_member_counts\"()");
+    end_phase(db);
+
+    // determine recipients of newly published newsletters:
+    begin_phase(db, "expand_newsletter_recipients");
+    exec_sql(db, NULL, &err, 0, "SET TRANSACTION ISOLATION LEVEL READ COMMITTED; " NO_STATEMENT_TIMEOUT "SELECT \"expand_newsletter_recipients\"()");
+    end_phase(db);
+
+  }
+
+  // issue admission and update of open issues for each claimed shard:
+  for (i=0; i<shard_count; i++) {
+    int shard = (first_shard + i) % shard_count;
+    int admission_failed;
+    if (shard_count > 1 && !claim(db, &err, SHARD_LOCK_CLASS, shard)) continue;
+    begin_phase(db, "admission");
+    admission_failed = admit_issues(db, &err, shard_count, shard);
+    end_phase(db);
+    begin_phase(db, "check_issues");
+    check_issues(db, &err, shard_count, shard, admission_failed);
+    end_phase(db);
+  }
+
+  // calculate ordering of issues in admission state and of suggestions (if enabled), which is a global task,
+  // as all areas, units, and initiatives are processed at once:
+  if (cycle && global_tasks && !deadline_passed()) {
+    if (slow_log_filename) {
+      lf_update_issue_order_slow_log(slow_log_filename, slow_log_threshold);
+      lf_update_suggestion_order_slow_log(slow_log_filename, slow_log_threshold);
+    }
+    // the ordering reads its input in bulk and cannot be split either (see NO_STATEMENT_TIMEOUT):
+    if (statement_timeout) exec_sql(db, NULL, &err, 0, "SET \"statement_timeout\" = 0");
+    metrics.ordered = 1;
+    begin_phase(db, "issue_order");
+    if (lf_update_issue_order(db, db)) err = 1;
+    end_phase(db);
+    begin_phase(db, "suggestion_order");
+    if (lf_update_suggestion_order(db, db)) err = 1;
+    end_phase(db);
+    if (statement_timeout) exec_sql(db, NULL, &err, 0, session_settings);
+  }
+
+  // delete unused snapshots (with a fresh budget):
+  if (global_tasks) {
+    begin_phase(db, "collect_unused_snapshots");
+    clock_gettime(CLOCK_MONOTONIC, &gc_budget.start);
+    gc_budget.rows = 0;
+    if (collect_garbage(db, &err, GC_UNUSED_SNAPSHOTS, &gc_budget)) gc_backlog = 1;
+    end_phase(db);
+  }
+
+  // report work which is left for the next run:
+  if (deadline_reached) fprintf(stderr, "Notice: Maximum run time exceeded; remaining areas and issues are left for the next run.\n");
+  if (gc_backlog) report_garbage_backlog(db, &err);
 
-  // delete unused snapshots:
-  exec_sql(db, NULL, &err, 0, "DELETE FROM \"unused_snapshot\"");
+  // write metrics (if enabled):
+  if (metrics_filename && write_metrics(err, seconds_since(&run_start))) err = 1;
 
    // cleanup and exit:
   PQfinish(db);
@@ -1,9 +1,25 @@
+#define _GNU_SOURCE  // for asprintf
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <libpq-fe.h>
 #include <search.h>
 
+// static tracepoints (USDT), which can be attached to with tools like bpftrace or perf and which are no-ops
+// otherwise; they are compiled in if the header file of SystemTap is available (see Makefile):
+#ifdef USE_SDT
+#include <sys/sdt.h>
+#else
+#define DTRACE_PROBE2(provider, name, arg1, arg2)
+#endif
+
 static int logging = 0;
 
 static char *escapeLiteral(PGconn *conn, const char *str, size_t len) {
@@ -27,10 +43,92 @@ static void freemem(void *ptr) {
   free(ptr);
 }
 
-// column numbers when querying "issue_supporter_in_admission_state" view in function main():
-#define COL_MEMBER_ID 0
-#define COL_WEIGHT    1
-#define COL_ISSUE_ID  2
+#ifndef LF_UPDATE_CYCLE
+
+// maximum time to wait for a hot standby to replay all changes of the primary (in 1/10 seconds):
+#define REPLICA_MAX_WAIT 100
+
+// connect to a hot standby and wait until it has replayed all changes committed on the primary so far,
+// such that data read from the standby is not older than data read from the primary at this point;
+// returns NULL (after printing a message) if the standby cannot be used, in which case the primary should be used for reading:
+static PGconn *connect_replica(PGconn *db, char *replica_conninfo) {
+  PGconn *replica;
+  PGresult *res;
+  char *lsn, *cmd;
+  int i;
+  // record current write-ahead log position of the primary:
+  res = PQexec(db, "SELECT pg_current_wal_lsn()");
+  if (!res) {
+    fprintf(stderr, "Error in pqlib while sending SQL command querying write-ahead log position of primary.\n");
+    return NULL;
+  } else if (PQresultStatus(res) != PGRES_TUPLES_OK || PQntuples(res) != 1) {
+    fprintf(stderr, "Error while executing SQL command querying write-ahead log position of primary:\n%s", PQresultErrorMessage(res));
+    PQclear(res);
+    return NULL;
+  }
+  lsn = escapeLiteral(db, PQgetvalue(res, 0, 0), strlen(PQgetvalue(res, 0, 0)));
+  PQclear(res);
+  if (!lsn) {
+    fprintf(stderr, "Could not escape literal in memory.\n");
+    abort();
+  }
+  if (asprintf(&cmd, "SELECT pg_is_in_recovery(), pg_last_wal_replay_lsn() >= %s::pg_lsn", lsn) < 0) {
+    fprintf(stderr, "Could not prepare query string in memory.\n");
+    abort();
+  }
+  if (logging) printf("Waiting for replica to replay write-ahead log up to position %s.\n", lsn);
+  freemem(lsn);
+  // connect to standby:
+  replica = PQconnectdb(replica_conninfo);
+  if (!replica) {
+    fprintf(stderr, "Error: Could not create database handle for replica.\n");
+    free(cmd);
+    return NULL;
+  }
+  if (PQstatus(replica) != CONNECTION_OK) {
+    fprintf(stderr, "Could not open connection to replica:\n%s", PQerrorMessage(replica));
+    PQfinish(replica);
+    free(cmd);
+    return NULL;
+  }
+  // wait until standby has caught up with recorded position:
+  for (i=0; i<REPLICA_MAX_WAIT; i++) {
+    struct timespec delay = { 0, 100000000 };
+    res = PQexec(replica, cmd);
+    if (!res) {
+      fprintf(stderr, "Error in pqlib while sending SQL command querying replay position of replica.\n");
+      break;
+    } else if (PQresultStatus(res) != PGRES_TUPLES_OK || PQntuples(res) != 1) {
+      fprintf(stderr, "Error while executing SQL command querying replay position of replica:\n%s", PQresultErrorMessage(res));
+      PQclear(res);
+      break;
+    } else if (PQgetvalue(res, 0, 0)[0] != 't') {
+      fprintf(stderr, "Replica is not a hot standby.\n");
+      PQclear(res);
+      break;
+    } else if (PQgetvalue(res, 0, 1)[0] == 't') {
+      PQclear(res);
+      free(cmd);
+      if (logging) printf("Replica has caught up with primary.\n");
+      return replica;
+    }
+    PQclear(res);
+    nanosleep(&delay, NULL);
+  }
+  if (i == REPLICA_MAX_WAIT) fprintf(stderr, "Replica did not catch up with primary in time.\n");
+  fprintf(stderr, "Reading data from primary instead of replica.\n");
+  PQfinish(replica);
+  free(cmd);
+  return NULL;
+}
+
+#endif
+
+// column numbers when querying "issue_supporter_in_admission_state" view in function lf_update_issue_order():
+#define COL_MEMBER_ID       0
+#define COL_WEIGHT          1
+#define COL_ISSUE_ID        2
+#define COL_AREA_OR_UNIT_ID 3
 
 // data structure for a candidate (in this case an issue) to the proportional runoff system:
 struct candidate {
@@ -88,10 +186,37 @@ struct ballot {
   struct candidate **candidates;  // all candidates equally preferred
 };
 
-// determine candidate, which is assigned the next seat (starting with the worst rank):
+// metrics of a run (see command line option "--metrics"):
+static struct {
+  int calculations;   // number of rankings calculated
+  int ballots;        // number of ballots in all calculations
+  long rounds;        // calls of loser()
+  long steps;         // iterations of the main loop in loser()
+  long rows_written;  // rows inserted, updated, or deleted (in committed transactions)
+  double db_time;     // seconds spent waiting for results of SQL commands
+  int statements;     // number of SQL commands sent (except for waiting for a replica)
+} metrics;
+
+// execute SQL command and add the time spent waiting for its result to the metrics:
+static PGresult *exec_counted(PGconn *db, char *cmd) {
+  PGresult *res;
+  struct timespec start, now;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  res = PQexec(db, cmd);
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  metrics.db_time += (double)(now.tv_sec - start.tv_sec) + (double)(now.tv_nsec - start.tv_nsec) / 1e9;
+  metrics.statements++;
+  return res;
+}
+
+// determine candidate, which is assigned the next seat (starting with the worst rank), with probes
+// "runoff_round__start" (arguments: round number and number of candidates) and "runoff_round__done"
+// (arguments: round number and key of determined candidate):
 static struct candidate *loser(int round_number, struct ballot *ballots, int ballot_count) {
   int i, j;       // index variables for loops
   int remaining;  // remaining candidates to be seated
+  metrics.rounds++;
+  DTRACE_PROBE2(lf_update_issue_order, runoff_round__start, round_number, candidate_count);
   // reset scores of all candidates:
   for (i=0; i<candidate_count; i++) {
     candidates[i].score = 0.0;
@@ -100,6 +225,7 @@ static struct candidate *loser(int round_number, struct ballot *ballots, int bal
   remaining = candidate_count - round_number;
   // repeat following loop, as long as there is more than one remaining candidate:
   while (remaining > 1) {
+    metrics.steps++;
     if (logging) printf("There are %i remaining candidates.\n", remaining);
     double scale;  // factor to be later multiplied with score_per_step:
     // reset score_per_step for all candidates:
@@ -166,19 +292,224 @@ static struct candidate *loser(int round_number, struct ballot *ballots, int bal
   }
   // return remaining candidate:
   for (i=0; i<candidate_count; i++) {
-    if (candidates[i].score < 1.0 && !candidates[i].seat) return candidates+i;
+    if (candidates[i].score < 1.0 && !candidates[i].seat) {
+      DTRACE_PROBE2(lf_update_issue_order, runoff_round__done, round_number, candidates[i].key);
+      return candidates+i;
+    }
   }
   // if there is no remaining candidate, then something went wrong:
   fprintf(stderr, "No remaining candidate (should not happen).");
   abort();
 }
 
+// assign seats to all candidates by calling loser() repeatedly (starting with the worst rank):
+static void calculate_ranks(struct ballot *ballots, int ballot_count) {
+  int i;
+  for (i=0; i<candidate_count; i++) {
+    struct candidate *candidate = loser(i, ballots, ballot_count);
+    candidate->seat = candidate_count - i;
+    if (logging) printf("Assigning rank #%i to issue #%s.\n", candidate_count-i, candidate->key);
+  }
+}
+
+// format of capture files (see command line options "--capture" and "--replay"): a header followed by one
+// record per area or unit, stored in native byte order and aligned to 8 bytes, such that a file can be mapped
+// into memory and processed in place; member ids are not stored:
+#define CAPTURE_MAGIC    0x6366666c  // "lffc" in little endian
+#define CAPTURE_VERSION  1
+#define CAPTURE_KIND     1           // 1 = issue order (1 section per ballot), 2 = suggestion order (4 sections per ballot)
+struct capture_header {
+  int32_t magic;
+  int32_t version;
+  int32_t kind;
+  int32_t reserved;
+};
+struct capture_record {
+  int64_t id;               // id of the area or unit
+  int32_t mode;             // 0 = area, 1 = unit
+  int32_t candidate_count;  // number of candidates, followed by their keys as int64_t values in ascending order
+  int32_t ballot_count;     // number of ballots
+  int32_t size;             // number of int32_t values following the keys: for each ballot its weight and for each section
+                            // the number of candidates followed by their indices; then a zero if needed to make the
+                            // number even; then the seat of each candidate
+};
+
+// capture file to which input and result of each calculation are written (NULL if not capturing):
+static FILE *capture_file = NULL;
+
+// write a single int32_t value to capture file; returns 1 on error, otherwise 0:
+static int capture_value(int32_t value) {
+  return fwrite(&value, sizeof(value), 1, capture_file) != 1;
+}
+
+// write a record to capture file after calculate_ranks() has been called; returns 1 on error, otherwise 0:
+static int capture(char *id, int mode, struct ballot *ballots, int ballot_count) {
+  struct capture_record record;
+  int i, j;
+  int size = candidate_count;
+  for (i=0; i<ballot_count; i++) size += 1 + 1 + ballots[i].count;
+  record.id = strtoll(id, NULL, 10);
+  record.mode = mode;
+  record.candidate_count = candidate_count;
+  record.ballot_count = ballot_count;
+  record.size = size + size % 2;
+  if (fwrite(&record, sizeof(record), 1, capture_file) != 1) return 1;
+  for (i=0; i<candidate_count; i++) {
+    int64_t key = strtoll(candidates[i].key, NULL, 10);
+    if (fwrite(&key, sizeof(key), 1, capture_file) != 1) return 1;
+  }
+  for (i=0; i<ballot_count; i++) {
+    if (capture_value(ballots[i].weight) || capture_value(ballots[i].count)) return 1;
+    for (j=0; j<ballots[i].count; j++) {
+      if (capture_value(ballots[i].candidates[j] - candidates)) return 1;
+    }
+  }
+  if (size % 2 && capture_value(0)) return 1;
+  for (i=0; i<candidate_count; i++) {
+    if (capture_value(candidates[i].seat)) return 1;
+  }
+  return 0;
+}
+
+#ifndef LF_UPDATE_CYCLE
+
+// calculate ranks for all records of a capture file (repeatedly, if repeat is greater than 1) and compare them
+// with the captured seats; returns 1 if the file is invalid or if any seat differs, otherwise 0:
+static int replay(char *filename, int repeat) {
+  int fd;
+  struct stat sb;
+  char *data;
+  size_t offset;
+  struct capture_header *header;
+  int record_count = 0, ballot_total = 0, mismatch_count = 0;
+  double seconds = 0.0;  // time spent in calculate_ranks()
+  fd = open(filename, O_RDONLY);
+  if (fd < 0) {
+    fprintf(stderr, "Could not open capture file \"%s\".\n", filename);
+    return 1;
+  }
+  if (fstat(fd, &sb)) {
+    fprintf(stderr, "Could not determine size of capture file \"%s\".\n", filename);
+    close(fd);
+    return 1;
+  }
+  if (sb.st_size < sizeof(struct capture_header)) {
+    fprintf(stderr, "Capture file \"%s\" is too short.\n", filename);
+    close(fd);
+    return 1;
+  }
+  data = mmap(NULL, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    fprintf(stderr, "Could not map capture file \"%s\" into memory.\n", filename);
+    return 1;
+  }
+  header = (struct capture_header *)data;
+  if (header->magic != CAPTURE_MAGIC || header->version != CAPTURE_VERSION || header->kind != CAPTURE_KIND) {
+    fprintf(stderr, "File \"%s\" is not a capture file of this program (or of a different version).\n", filename);
+    munmap(data, sb.st_size);
+    return 1;
+  }
+  for (offset = sizeof(struct capture_header); offset < sb.st_size; record_count++) {
+    struct capture_record *record;
+    int64_t *keys;
+    int32_t *values, *seats;
+    int pos = 0, end;
+    char *key_strings;
+    struct ballot *ballots;
+    int ballot_count, i, j;
+    record = (struct capture_record *)(data + offset);
+    if (
+      sb.st_size - offset < sizeof(struct capture_record) ||
+      record->candidate_count < 0 || record->ballot_count < 0 || record->size < record->candidate_count ||
+      (sb.st_size - offset - sizeof(struct capture_record)) / 4 < 2 * (size_t)record->candidate_count + record->size
+    ) {
+      fprintf(stderr, "Capture file \"%s\" is truncated or corrupt.\n", filename);
+      munmap(data, sb.st_size);
+      return 1;
+    }
+    keys = (int64_t *)(record + 1);
+    values = (int32_t *)(keys + record->candidate_count);
+    end = record->size - record->candidate_count;  // number of values before seats (including padding)
+    seats = values + end;
+    offset += sizeof(struct capture_record) + 8 * (size_t)record->candidate_count + 4 * (size_t)record->size;
+    // create candidates[] and ballots[] arrays:
+    candidate_count = record->candidate_count;
+    candidates = malloc(candidate_count * sizeof(struct candidate) + 1);
+    key_strings = malloc(candidate_count * 21 + 1);
+    if (!candidates || !key_strings) {
+      fprintf(stderr, "Insufficient memory while creating candidate list.\n");
+      abort();
+    }
+    for (i=0; i<candidate_count; i++) {
+      candidates[i].key = key_strings + 21 * i;
+      snprintf(candidates[i].key, 21, "%lld", (long long)keys[i]);
+    }
+    ballot_count = record->ballot_count;
+    ballots = calloc(ballot_count + 1, sizeof(struct ballot));
+    if (!ballots) {
+      fprintf(stderr, "Insufficient memory while creating ballot list.\n");
+      abort();
+    }
+    for (i=0; i<ballot_count; i++) {
+      if (pos + 2 > end) goto replay_invalid_record;
+      ballots[i].weight = values[pos++];
+      ballots[i].count = values[pos++];
+      if (ballots[i].count < 0 || ballots[i].count > end - pos) goto replay_invalid_record;
+      ballots[i].candidates = malloc(ballots[i].count * sizeof(struct candidate *) + 1);
+      if (!ballots[i].candidates) {
+        fprintf(stderr, "Insufficient memory while creating ballot section.\n");
+        abort();
+      }
+      for (j=0; j<ballots[i].count; j++) {
+        if (values[pos] < 0 || values[pos] >= candidate_count) goto replay_invalid_record;
+        ballots[i].candidates[j] = candidates + values[pos++];
+      }
+    }
+    // calculate ranks and compare them with captured seats:
+    for (j=0; j<repeat; j++) {
+      struct timespec start, stop;
+      for (i=0; i<candidate_count; i++) candidates[i].seat = 0;
+      clock_gettime(CLOCK_MONOTONIC, &start);
+      calculate_ranks(ballots, ballot_count);
+      clock_gettime(CLOCK_MONOTONIC, &stop);
+      seconds += (double)(stop.tv_sec - start.tv_sec) + (double)(stop.tv_nsec - start.tv_nsec) / 1e9;
+    }
+    for (i=0; i<candidate_count; i++) {
+      if (candidates[i].seat != seats[i]) {
+        fprintf(stderr, "Seats differ from captured seats for area or unit #%lld.\n", (long long)record->id);
+        mismatch_count++;
+        break;
+      }
+    }
+    ballot_total += ballot_count;
+    goto replay_free_record;
+    replay_invalid_record:
+    fprintf(stderr, "Invalid ballot in record for area or unit #%lld.\n", (long long)record->id);
+    mismatch_count++;
+    replay_free_record:
+    // free ballots[] and candidates[] arrays:
+    for (i=0; i<ballot_count; i++) {
+      free(ballots[i].candidates);
+    }
+    free(ballots);
+    free(key_strings);
+    free(candidates);
+  }
+  munmap(data, sb.st_size);
+  printf("Replayed %i records with %i ballots (%i times each) in %.6f seconds, %i records with differing seats.\n", record_count, ballot_total, repeat, seconds, mismatch_count);
+  return mismatch_count ? 1 : 0;
+}
+
+#endif
+
 // write results to database:
 static int write_ranks(PGconn *db, char *escaped_area_or_unit_id, char *mode) {
   PGresult *res;
   char *cmd;
   int i;
-  res = PQexec(db, "BEGIN");
+  long rows = 0;  // number of rows updated in the transaction
+  res = exec_counted(db, "BEGIN");
   if (!res) {
     fprintf(stderr, "Error in pqlib while sending SQL command to initiate issue order update.\n");
     return 1;
@@ -204,7 +535,7 @@ static int write_ranks(PGconn *db, char *escaped_area_or_unit_id, char *mode) {
       abort();
     }
     freemem(escaped_issue_id);
-    res = PQexec(db, cmd);
+    res = exec_counted(db, cmd);
     free(cmd);
     if (!res) {
       fprintf(stderr, "Error in pqlib while sending SQL command to update issue order.\n");
@@ -215,14 +546,15 @@ static int write_ranks(PGconn *db, char *escaped_area_or_unit_id, char *mode) {
       fprintf(stderr, "Error while executing SQL command to update issue order:\n%s", PQresultErrorMessage(res));
       PQclear(res);
     } else {
+      rows += atol(PQcmdTuples(res));
       PQclear(res);
       continue;
     }
-    res = PQexec(db, "ROLLBACK");
+    res = exec_counted(db, "ROLLBACK");
     if (res) PQclear(res);
     return 1;
   }
-  res = PQexec(db, "COMMIT");
+  res = exec_counted(db, "COMMIT");
   if (!res) {
     fprintf(stderr, "Error in pqlib while sending SQL command to commit transaction.\n");
     return 1;
@@ -236,39 +568,41 @@ static int write_ranks(PGconn *db, char *escaped_area_or_unit_id, char *mode) {
   } else {
     PQclear(res);
   }
+  metrics.rows_written += rows;
   return 0;
 }
 
-// calculate ordering of issues in admission state for an area and call write_ranks() to write it to database:
-static int process_area_or_unit(PGconn *db, PGresult *res, char *escaped_area_or_unit_id, char *mode) {
+// calculate ordering of issues in admission state for an area (using tuple_count rows of res starting with first_row)
+// and call write_ranks() to write it to database:
+static int process_area_or_unit(PGconn *db, PGresult *res, int first_row, int tuple_count, char *area_or_unit_id, char *escaped_area_or_unit_id, char *mode) {
   int err;                 // variable to store an error condition (0 = success)
+  int capture_err = 0;     // set to 1 if capture file could not be written
   int ballot_count = 1;    // number of ballots, must be initiatized to 1, due to loop below
   struct ballot *ballots;  // data structure containing the ballots
   int i;                   // index variable for loops
   // create candidates[] and ballots[] arrays:
   {
     void *candidate_tree = NULL;  // temporary structure to create a sorted unique list of all candidate keys
-    int tuple_count;              // number of tuples returned from the database
     char *old_member_id = NULL;   // old member_id to be able to detect a new ballot in loops
     struct ballot *ballot;        // pointer to current ballot
     int candidates_in_ballot = 0; // number of candidates in ballot
     // reset candidate count:
     candidate_count = 0;
-    // determine number of tuples:
-    tuple_count = PQntuples(res);
     // trivial case, when there are no tuples:
     if (!tuple_count) {
       // write results to database:
       if (logging) printf("No supporters for any issue. Writing ranks to database.\n");
+      DTRACE_PROBE2(lf_update_issue_order, write_ranks__start, escaped_area_or_unit_id, candidate_count);
       err = write_ranks(db, escaped_area_or_unit_id, mode);
+      DTRACE_PROBE2(lf_update_issue_order, write_ranks__done, escaped_area_or_unit_id, err);
       if (logging) printf("Done.\n");
       return 0;
     }
     // calculate ballot_count and generate set of candidate keys (issue_id is used as key):
     for (i=0; i<tuple_count; i++) {
       char *member_id, *issue_id;
-      member_id = PQgetvalue(res, i, COL_MEMBER_ID);
-      issue_id = PQgetvalue(res, i, COL_ISSUE_ID);
+      member_id = PQgetvalue(res, first_row+i, COL_MEMBER_ID);
+      issue_id = PQgetvalue(res, first_row+i, COL_ISSUE_ID);
       if (!candidate_tree || !tfind(issue_id, &candidate_tree, (void *)compare_id)) {
         candidate_count++;
         if (!tsearch(issue_id, &candidate_tree, (void *)compare_id)) {
@@ -302,8 +636,8 @@ static int process_area_or_unit(PGconn *db, PGresult *res, char *escaped_area_or
     for (i=0; i<tuple_count; i++) {
       char *member_id;
       int weight;
-      member_id = PQgetvalue(res, i, COL_MEMBER_ID);
-      weight = (int)strtol(PQgetvalue(res, i, COL_WEIGHT), (char **)NULL, 10);
+      member_id = PQgetvalue(res, first_row+i, COL_MEMBER_ID);
+      weight = (int)strtol(PQgetvalue(res, first_row+i, COL_WEIGHT), (char **)NULL, 10);
       if (weight <= 0) {
         fprintf(stderr, "Unexpected weight value.\n");
         free(ballots);
@@ -330,8 +664,8 @@ static int process_area_or_unit(PGconn *db, PGresult *res, char *escaped_area_or
     ballot = ballots;
     for (i=0; i<tuple_count; i++) {
       char *member_id, *issue_id;
-      member_id = PQgetvalue(res, i, COL_MEMBER_ID);
-      issue_id = PQgetvalue(res, i, COL_ISSUE_ID);
+      member_id = PQgetvalue(res, first_row+i, COL_MEMBER_ID);
+      issue_id = PQgetvalue(res, first_row+i, COL_ISSUE_ID);
       if (old_member_id && strcmp(old_member_id, member_id)) {
         ballot++;
         candidates_in_ballot = 0;
@@ -356,10 +690,14 @@ static int process_area_or_unit(PGconn *db, PGresult *res, char *escaped_area_or
   }
 
   // calculate ranks based on constructed data structures:
-  for (i=0; i<candidate_count; i++) {
-    struct candidate *candidate = loser(i, ballots, ballot_count);
-    candidate->seat = candidate_count - i;
-    if (logging) printf("Assigning rank #%i to issue #%s.\n", candidate_count-i, candidate->key);
+  calculate_ranks(ballots, ballot_count);
+  metrics.calculations++;
+  metrics.ballots += ballot_count;
+
+  // write input and result to capture file, if enabled:
+  if (capture_file && capture(area_or_unit_id, strcmp(mode, "unit") ? 0 : 1, ballots, ballot_count)) {
+    fprintf(stderr, "Could not write to capture file.\n");
+    capture_err = 1;
   }
 
   // free ballots[] array:
@@ -372,24 +710,289 @@ static int process_area_or_unit(PGconn *db, PGresult *res, char *escaped_area_or
 
   // write results to database:
   if (logging) printf("Writing ranks to database.\n");
+  DTRACE_PROBE2(lf_update_issue_order, write_ranks__start, escaped_area_or_unit_id, candidate_count);
   err = write_ranks(db, escaped_area_or_unit_id, mode);
+  DTRACE_PROBE2(lf_update_issue_order, write_ranks__done, escaped_area_or_unit_id, err);
   if (logging) printf("Done.\n");
 
   // free candidates[] array:
   free(candidates);
 
-  // return error code of write_ranks() call
+  // return error code of write_ranks() call (or error writing capture file)
+  return err ? err : capture_err;
+}
+
+// log of slow SQL commands with their plans (see command line options "--slow-log" and "--slow-threshold"):
+#define SLOW_LOG_DEFAULT_THRESHOLD  1000      // milliseconds
+#define SLOW_LOG_MAX_SIZE           10000000  // bytes, after which the log file is renamed to <file>.old
+static char *slow_log_filename = NULL;        // NULL = disabled
+static int slow_log_threshold = SLOW_LOG_DEFAULT_THRESHOLD;
+
+#ifdef LF_UPDATE_CYCLE
+// enable the slow statement log for the reads of lf_update_issue_order() when called by lf_update
+// (see options "--slow-log" and "--slow-threshold" there):
+void lf_update_issue_order_slow_log(char *filename, int threshold) {
+  slow_log_filename = filename;
+  slow_log_threshold = threshold;
+}
+#endif
+
+// execute SQL command reading input data for the given object (e.g. "area #17"); if the command takes
+// longer than the slow threshold, then an entry with the output of EXPLAIN (ANALYZE, BUFFERS) for the
+// command is appended to the slow statement log:
+static PGresult *exec_input(PGconn *db, char *cmd, char *object) {
+  PGresult *res, *res2;
+  struct timespec start, now;
+  double duration;
+  struct stat sb;
+  FILE *out;
+  time_t timestamp;
+  char timestamp_string[20];
+  char *explain;
+  int i;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  res = exec_counted(db, cmd);
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  duration = (double)(now.tv_sec - start.tv_sec) + (double)(now.tv_nsec - start.tv_nsec) / 1e9;
+  if (!slow_log_filename || !res || duration * 1000 < slow_log_threshold) return res;
+  // rename log file if it is too big, such that the size of the log is limited:
+  if (!stat(slow_log_filename, &sb) && sb.st_size >= SLOW_LOG_MAX_SIZE) {
+    char *old_filename;
+    if (asprintf(&old_filename, "%s.old", slow_log_filename) >= 0) {
+      rename(slow_log_filename, old_filename);
+      free(old_filename);
+    }
+  }
+  out = fopen(slow_log_filename, "a");
+  if (!out) {
+    fprintf(stderr, "Could not open slow statement log \"%s\".\n", slow_log_filename);
+    return res;
+  }
+  timestamp = time(NULL);
+  strftime(timestamp_string, sizeof(timestamp_string), "%Y-%m-%d %H:%M:%S", localtime(&timestamp));
+  fprintf(out, "=== %s phase=input object=%s duration=%.3fms\n%s\n", timestamp_string, object, duration * 1000, cmd);
+  if (asprintf(&explain, "EXPLAIN (ANALYZE, BUFFERS) %s", cmd) < 0) {
+    fprintf(out, "Could not determine plan: out of memory\n");
+  } else {
+    res2 = PQexec(db, explain);
+    free(explain);
+    if (PQresultStatus(res2) == PGRES_TUPLES_OK) {
+      for (i=0; i<PQntuples(res2); i++) fprintf(out, "%s\n", PQgetvalue(res2, i, 0));
+    } else {
+      fprintf(out, "Could not determine plan: %s", res2 ? PQresultErrorMessage(res2) : "out of memory\n");
+    }
+    PQclear(res2);
+  }
+  fprintf(out, "\n");
+  fclose(out);
+  return res;
+}
+
+// execute SQL command reading input data (see exec_input()) and check its result, where description is used
+// for error messages; returns NULL on error:
+static PGresult *read_input(PGconn *db, char *cmd, char *object, char *description, int min_fields) {
+  PGresult *res;
+  res = exec_input(db, cmd, object);
+  if (!res) {
+    fprintf(stderr, "Error in pqlib while sending SQL command %s.\n", description);
+  } else if (PQresultStatus(res) != PGRES_TUPLES_OK) {
+    fprintf(stderr, "Error while executing SQL command %s:\n%s", description, PQresultErrorMessage(res));
+    PQclear(res);
+    res = NULL;
+  } else if (PQnfields(res) < min_fields) {
+    fprintf(stderr, "Too few columns returned by SQL command %s.\n", description);
+    PQclear(res);
+    res = NULL;
+  }
+  return res;
+}
+
+// calculate ordering of issues for all areas (mode "area") or all units (mode "unit") given by ids (in ascending
+// order), where supporters contains the rows of "issue_supporter_in_admission_state" for all of them, ordered by
+// area or unit id and member id:
+static int process_all(PGconn *db, PGresult *ids, PGresult *supporters, char *mode) {
+  int err = 0;
+  int row = 0;  // current row in supporters
+  int row_count = PQntuples(supporters);
+  int i;
+  if (logging) printf("Number of %ss to process: %i\n", mode, PQntuples(ids));
+  for (i=0; i<PQntuples(ids); i++) {
+    char *id, *escaped_id;
+    long long numeric_id;
+    int first_row;
+    id = PQgetvalue(ids, i, 0);
+    numeric_id = atoll(id);
+    if (logging) printf("Processing %s #%s:\n", mode, id);
+    escaped_id = escapeLiteral(db, id, strlen(id));
+    if (!escaped_id) {
+      fprintf(stderr, "Could not escape literal in memory.\n");
+      abort();
+    }
+    while (row < row_count && atoll(PQgetvalue(supporters, row, COL_AREA_OR_UNIT_ID)) < numeric_id) row++;
+    first_row = row;
+    while (row < row_count && atoll(PQgetvalue(supporters, row, COL_AREA_OR_UNIT_ID)) == numeric_id) row++;
+    if (process_area_or_unit(db, supporters, first_row, row - first_row, id, escaped_id, mode)) err = 1;
+    freemem(escaped_id);
+  }
   return err;
 }
 
+// calculate ordering of issues in admission state for all areas and units and write it to database (using db_read
+// for reading input data); all input data is read at once within a single snapshot, before any calculation is
+// done; this function is also called by lf_update (see option "--cycle" there); returns 1 on error:
+int lf_update_issue_order(PGconn *db, PGconn *db_read) {
+  int err = 0;
+  int input_err = 0;  // set to 1 if input data could not be read
+  PGresult *res;
+  PGresult *areas = NULL, *units = NULL, *area_supporters = NULL, *unit_supporters = NULL;
+
+  // create missing "issue_order_in_admission_state" entries for issues
+  res = exec_counted(db, "INSERT INTO \"issue_order_in_admission_state\" (\"id\") SELECT \"issue\".\"id\" FROM \"issue\" NATURAL LEFT JOIN \"issue_order_in_admission_state\" WHERE \"issue\".\"state\" = 'admission'::\"issue_state\" AND \"issue_order_in_admission_state\".\"id\" ISNULL");
+  if (!res) {
+    fprintf(stderr, "Error in pqlib while sending SQL command creating new issue order entries.\n");
+    err = 1;
+  } else if (
+    PQresultStatus(res) != PGRES_COMMAND_OK &&
+    PQresultStatus(res) != PGRES_TUPLES_OK
+  ) {
+    fprintf(stderr, "Error while executing SQL command creating new issue order entries:\n%s", PQresultErrorMessage(res));
+    err = 1;
+    PQclear(res);
+  } else {
+    if (logging) printf("Created %s new issue order entries.\n", PQcmdTuples(res));
+    metrics.rows_written += atol(PQcmdTuples(res));
+    PQclear(res);
+  }
+
+  // read input data within a single snapshot:
+  res = exec_counted(db_read, "BEGIN ISOLATION LEVEL REPEATABLE READ READ ONLY");
+  if (!res || PQresultStatus(res) != PGRES_COMMAND_OK) {
+    fprintf(stderr, "Error while starting transaction reading input data:\n%s", res ? PQresultErrorMessage(res) : PQerrorMessage(db_read));
+    input_err = 1;
+  } else if (
+    !(areas = read_input(db_read, "SELECT \"id\" FROM \"area\" ORDER BY \"id\"", "areas", "selecting areas to process", 1)) ||
+    !(units = read_input(db_read, "SELECT \"id\" FROM \"unit\" ORDER BY \"id\"", "units", "selecting units to process", 1)) ||
+    !(area_supporters = read_input(db_read, "SELECT \"member_id\", \"weight\", \"issue_id\", \"area_id\" FROM \"issue_supporter_in_admission_state\" ORDER BY \"area_id\", \"member_id\"", "all areas", "selecting issue supporter in admission state", 4)) ||
+    !(unit_supporters = read_input(db_read, "SELECT \"member_id\", \"weight\", \"issue_id\", \"unit_id\" FROM \"issue_supporter_in_admission_state\" ORDER BY \"unit_id\", \"member_id\"", "all units", "selecting issue supporter in admission state", 4))
+  ) {
+    input_err = 1;
+  }
+  PQclear(res);
+  res = exec_counted(db_read, "COMMIT");
+  PQclear(res);
+
+  // calculate and write ordering for all areas and units:
+  if (input_err) {
+    err = 1;
+  } else {
+    if (process_all(db, areas, area_supporters, "area")) err = 1;
+    if (process_all(db, units, unit_supporters, "unit")) err = 1;
+  }
+  PQclear(areas);
+  PQclear(units);
+  PQclear(area_supporters);
+  PQclear(unit_supporters);
+
+  // clean-up entries of deleted issues
+  res = exec_counted(db, "DELETE FROM \"issue_order_in_admission_state\" USING \"issue_order_in_admission_state\" AS \"self\" NATURAL LEFT JOIN \"issue\" WHERE \"issue_order_in_admission_state\".\"id\" = \"self\".\"id\" AND (\"issue\".\"id\" ISNULL OR \"issue\".\"state\" != 'admission'::\"issue_state\")");
+  if (!res) {
+    fprintf(stderr, "Error in pqlib while sending SQL command deleting ordering data of deleted issues.\n");
+    err = 1;
+  } else if (
+    PQresultStatus(res) != PGRES_COMMAND_OK &&
+    PQresultStatus(res) != PGRES_TUPLES_OK
+  ) {
+    fprintf(stderr, "Error while executing SQL command deleting ordering data of deleted issues:\n%s", PQresultErrorMessage(res));
+    err = 1;
+    PQclear(res);
+  } else {
+    if (logging) printf("Cleaned up ordering data of %s deleted issues.\n", PQcmdTuples(res));
+    metrics.rows_written += atol(PQcmdTuples(res));
+    PQclear(res);
+  }
+
+  return err;
+}
+
+
+// print HELP and TYPE lines of a metric in the text format of the Prometheus node exporter:
+static void metric_header(FILE *out, char *name, char *help) {
+  fprintf(out, "# HELP %s %s\n# TYPE %s gauge\n", name, help, name);
+}
+
+// write the counters of the run (without success, timestamp, and duration) in the text format of the
+// Prometheus node exporter; also called by lf_update, when the ordering is part of its run (see option
+// "--cycle" there):
+void lf_update_issue_order_write_metrics(FILE *out) {
+  metric_header(out, "lf_update_issue_order_calculations", "Areas and units for which a ranking has been calculated in the last run");
+  fprintf(out, "lf_update_issue_order_calculations %i\n", metrics.calculations);
+  metric_header(out, "lf_update_issue_order_ballots", "Ballots counted in the last run");
+  fprintf(out, "lf_update_issue_order_ballots %i\n", metrics.ballots);
+  metric_header(out, "lf_update_issue_order_runoff_rounds", "Rounds of the proportional runoff (one per assigned rank) in the last run");
+  fprintf(out, "lf_update_issue_order_runoff_rounds %ld\n", metrics.rounds);
+  metric_header(out, "lf_update_issue_order_runoff_steps", "Steps of all rounds of the proportional runoff in the last run");
+  fprintf(out, "lf_update_issue_order_runoff_steps %ld\n", metrics.steps);
+  metric_header(out, "lf_update_issue_order_rows_written", "Rows inserted, updated, or deleted in the last run");
+  fprintf(out, "lf_update_issue_order_rows_written %ld\n", metrics.rows_written);
+  metric_header(out, "lf_update_issue_order_database_seconds", "Time spent waiting for the database in the last run");
+  fprintf(out, "lf_update_issue_order_database_seconds %.6f\n", metrics.db_time);
+  metric_header(out, "lf_update_issue_order_statements", "SQL commands sent in the last run");
+  fprintf(out, "lf_update_issue_order_statements %i\n", metrics.statements);
+}
+
+#ifndef LF_UPDATE_CYCLE
+
+// write metrics of the run in the text format of the Prometheus node exporter ("textfile" collector) to
+// a temporary file, which is then renamed, such that the metrics file is replaced atomically; returns 1
+// on error, otherwise 0:
+static int write_metrics(char *filename, int err, struct timespec *start) {
+  char *tmp_filename;
+  FILE *out;
+  struct timespec now;
+  int write_err;
+  if (asprintf(&tmp_filename, "%s.%i.tmp", filename, (int)getpid()) < 0) {
+    fprintf(stderr, "Could not prepare filename in memory.\n");
+    return 1;
+  }
+  out = fopen(tmp_filename, "w");
+  if (!out) {
+    fprintf(stderr, "Could not create metrics file \"%s\".\n", tmp_filename);
+    free(tmp_filename);
+    return 1;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  metric_header(out, "lf_update_issue_order_success", "Whether the last run completed without errors");
+  fprintf(out, "lf_update_issue_order_success %i\n", err ? 0 : 1);
+  metric_header(out, "lf_update_issue_order_last_run_timestamp_seconds", "Time when the last run finished");
+  fprintf(out, "lf_update_issue_order_last_run_timestamp_seconds %lld\n", (long long)time(NULL));
+  metric_header(out, "lf_update_issue_order_duration_seconds", "Wall time of the last run");
+  fprintf(out, "lf_update_issue_order_duration_seconds %.6f\n", (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / 1e9);
+  lf_update_issue_order_write_metrics(out);
+  write_err = ferror(out);
+  if (fclose(out) || write_err || rename(tmp_filename, filename)) {
+    fprintf(stderr, "Could not write metrics file \"%s\".\n", filename);
+    unlink(tmp_filename);
+    free(tmp_filename);
+    return 1;
+  }
+  free(tmp_filename);
+  return 0;
+}
+
 int main(int argc, char **argv) {
 
   // variable declarations:
   int err = 0;
-  int i, count;
+  int i;
   char *conninfo;
+  char *replica_conninfo = NULL;
+  char *capture_filename = NULL;
+  char *replay_filename = NULL;
+  char *metrics_filename = NULL;
+  struct timespec run_start;  // time when program has been started (for metrics)
+  int repeat = 1;             // number of calculations per record when replaying
   PGconn *db;
-  PGresult *res;
+  PGconn *db_read;  // connection used for reading input data (either replica or db)
 
   // parse command line:
   if (argc == 0) return 1;
@@ -397,7 +1000,26 @@ int main(int argc, char **argv) {
     FILE *out;
     out = argc == 1 ? stderr : stdout;
     fprintf(out, "\n");
-    fprintf(out, "Usage: %s [-v|--verbose] <conninfo>\n", argv[0]);
+    fprintf(out, "Usage: %s [-v|--verbose] [-r|--replica <conninfo>] [-c|--capture <file>] [-m|--metrics <file>]\n", argv[0]);
+    fprintf(out, "       %*s [--slow-log <file> [--slow-threshold <ms>]] <conninfo>\n", (int)strlen(argv[0]), "");
+    fprintf(out, "       %s [-v|--verbose] [--repeat <count>] --replay <file>\n", argv[0]);
+    fprintf(out, "\n");
+    fprintf(out, "If a replica is given, which must be a hot standby of the database,\n");
+    fprintf(out, "then input data is read from the replica (after it has caught up with\n");
+    fprintf(out, "the primary), while results are written to the primary.\n");
+    fprintf(out, "\n");
+    fprintf(out, "If a capture file is given, then the ballots (without member ids) and\n");
+    fprintf(out, "the calculated ranks of each area or unit are written to that file.\n");
+    fprintf(out, "With --replay, the ranks are calculated again from a capture file\n");
+    fprintf(out, "(repeatedly, if requested) without connecting to a database, and\n");
+    fprintf(out, "compared with the captured ranks; the exit code is 1 if they differ.\n");
+    fprintf(out, "\n");
+    fprintf(out, "If a metrics file is given, then it is replaced after each run with\n");
+    fprintf(out, "metrics in the text format of the Prometheus node exporter.\n");
+    fprintf(out, "\n");
+    fprintf(out, "If a slow log file is given, then queries reading input data which take\n");
+    fprintf(out, "longer than the slow threshold (default %i milliseconds) are appended\n", SLOW_LOG_DEFAULT_THRESHOLD);
+    fprintf(out, "to that file together with the output of EXPLAIN (ANALYZE, BUFFERS).\n");
     fprintf(out, "\n");
     fprintf(out, "<conninfo> is specified by PostgreSQL's libpq,\n");
     fprintf(out, "see http://www.postgresql.org/docs/9.1/static/libpq-connect.html\n");
@@ -408,13 +1030,64 @@ int main(int argc, char **argv) {
   }
   {
     size_t len = 0;
-    int argb = 1;
-    if (
-      argc >= 2 &&
-      (!strcmp(argv[1], "-v") || !strcmp(argv[1], "--verbose"))
-    ) {
-      argb = 2;
-      logging = 1;
+    int argb;
+    for (argb=1; argb<argc && argv[argb][0] == '-'; argb++) {
+      if (!strcmp(argv[argb], "-v") || !strcmp(argv[argb], "--verbose")) {
+        logging = 1;
+      } else if (!strcmp(argv[argb], "-r") || !strcmp(argv[argb], "--replica")) {
+        if (++argb >= argc) {
+          fprintf(stderr, "Error: Option \"%s\" requires an argument.\n", argv[argb-1]);
+          return 1;
+        }
+        replica_conninfo = argv[argb];
+      } else if (!strcmp(argv[argb], "-c") || !strcmp(argv[argb], "--capture")) {
+        if (++argb >= argc) {
+          fprintf(stderr, "Error: Option \"%s\" requires an argument.\n", argv[argb-1]);
+          return 1;
+        }
+        capture_filename = argv[argb];
+      } else if (!strcmp(argv[argb], "--replay")) {
+        if (++argb >= argc) {
+          fprintf(stderr, "Error: Option \"%s\" requires an argument.\n", argv[argb-1]);
+          return 1;
+        }
+        replay_filename = argv[argb];
+      } else if (!strcmp(argv[argb], "-m") || !strcmp(argv[argb], "--metrics")) {
+        if (++argb >= argc) {
+          fprintf(stderr, "Error: Option \"%s\" requires an argument.\n", argv[argb-1]);
+          return 1;
+        }
+        metrics_filename = argv[argb];
+      } else if (!strcmp(argv[argb], "--slow-log")) {
+        if (++argb >= argc) {
+          fprintf(stderr, "Error: Option \"%s\" requires an argument.\n", argv[argb-1]);
+          return 1;
+        }
+        slow_log_filename = argv[argb];
+      } else if (!strcmp(argv[argb], "--slow-threshold")) {
+        if (++argb >= argc) {
+          fprintf(stderr, "Error: Option \"%s\" requires an argument.\n", argv[argb-1]);
+          return 1;
+        }
+        slow_log_threshold = atoi(argv[argb]);
+        if (slow_log_threshold < 0) {
+          fprintf(stderr, "Error: Option \"%s\" requires a non-negative integer as argument.\n", argv[argb-1]);
+          return 1;
+        }
+      } else if (!strcmp(argv[argb], "--repeat")) {
+        if (++argb >= argc) {
+          fprintf(stderr, "Error: Option \"%s\" requires an argument.\n", argv[argb-1]);
+          return 1;
+        }
+        repeat = atoi(argv[argb]);
+        if (repeat < 1) {
+          fprintf(stderr, "Error: Option \"%s\" requires a positive integer as argument.\n", argv[argb-1]);
+          return 1;
+        }
+      } else {
+        fprintf(stderr, "Error: Unknown option \"%s\".\n", argv[argb]);
+        return 1;
+      }
     }
     for (i=argb; i<argc; i++) len += strlen(argv[i]) + 1;
     if (!len) len = 1;  // not needed but suppresses compiler warning
@@ -430,6 +1103,22 @@ int main(int argc, char **argv) {
     }
   }
 
+  // remember start time for metrics:
+  clock_gettime(CLOCK_MONOTONIC, &run_start);
+
+  // replay capture file without connecting to database, if requested:
+  if (replay_filename) return replay(replay_filename, repeat);
+
+  // open capture file, if requested:
+  if (capture_filename) {
+    struct capture_header header = { CAPTURE_MAGIC, CAPTURE_VERSION, CAPTURE_KIND, 0 };
+    capture_file = fopen(capture_filename, "wb");
+    if (!capture_file || fwrite(&header, sizeof(header), 1, capture_file) != 1) {
+      fprintf(stderr, "Error: Could not write capture file \"%s\".\n", capture_filename);
+      return 1;
+    }
+  }
+
   // connect to database:
   db = PQconnectdb(conninfo);
   if (!db) {
@@ -438,151 +1127,28 @@ int main(int argc, char **argv) {
   }
   if (PQstatus(db) != CONNECTION_OK) {
     fprintf(stderr, "Could not open connection:\n%s", PQerrorMessage(db));
+    if (metrics_filename) write_metrics(metrics_filename, 1, &run_start);
     return 1;
   }
 
-  // create missing "issue_order_in_admission_state" entries for issues
-  res = PQexec(db, "INSERT INTO \"issue_order_in_admission_state\" (\"id\") SELECT \"issue\".\"id\" FROM \"issue\" NATURAL LEFT JOIN \"issue_order_in_admission_state\" WHERE \"issue\".\"state\" = 'admission'::\"issue_state\" AND \"issue_order_in_admission_state\".\"id\" ISNULL");
-  if (!res) {
-    fprintf(stderr, "Error in pqlib while sending SQL command creating new issue order entries.\n");
-    err = 1;
-  } else if (
-    PQresultStatus(res) != PGRES_COMMAND_OK &&
-    PQresultStatus(res) != PGRES_TUPLES_OK
-  ) {
-    fprintf(stderr, "Error while executing SQL command creating new issue order entries:\n%s", PQresultErrorMessage(res));
-    err = 1;
-    PQclear(res);
-  } else {
-    if (logging) printf("Created %s new issue order entries.\n", PQcmdTuples(res));
-    PQclear(res);
-  }
-
-  // go through areas:
-  res = PQexec(db, "SELECT \"id\" FROM \"area\"");
-  if (!res) {
-    fprintf(stderr, "Error in pqlib while sending SQL command selecting areas to process.\n");
-    err = 1;
-  } else if (PQresultStatus(res) != PGRES_TUPLES_OK) {
-    fprintf(stderr, "Error while executing SQL command selecting areas to process:\n%s", PQresultErrorMessage(res));
-    err = 1;
-    PQclear(res);
-  } else if (PQnfields(res) < 1) {
-    fprintf(stderr, "Too few columns returned by SQL command selecting areas to process.\n");
-    err = 1;
-    PQclear(res);
-  } else {
-    count = PQntuples(res);
-    if (logging) printf("Number of areas to process: %i\n", count);
-    for (i=0; i<count; i++) {
-      char *area_id, *escaped_area_id;
-      char *cmd;
-      PGresult *res2;
-      area_id = PQgetvalue(res, i, 0);
-      if (logging) printf("Processing area #%s:\n", area_id);
-      escaped_area_id = escapeLiteral(db, area_id, strlen(area_id));
-      if (!escaped_area_id) {
-        fprintf(stderr, "Could not escape literal in memory.\n");
-        abort();
-      }
-      if (asprintf(&cmd, "SELECT \"member_id\", \"weight\", \"issue_id\" FROM \"issue_supporter_in_admission_state\" WHERE \"area_id\" = %s ORDER BY \"member_id\"", escaped_area_id) < 0) {
-        fprintf(stderr, "Could not prepare query string in memory.\n");
-        abort();
-      }
-      res2 = PQexec(db, cmd);
-      free(cmd);
-      if (!res2) {
-        fprintf(stderr, "Error in pqlib while sending SQL command selecting issue supporter in admission state.\n");
-        err = 1;
-      } else if (PQresultStatus(res2) != PGRES_TUPLES_OK) {
-        fprintf(stderr, "Error while executing SQL command selecting issue supporter in admission state:\n%s", PQresultErrorMessage(res));
-        err = 1;
-        PQclear(res2);
-      } else if (PQnfields(res2) < 3) {
-        fprintf(stderr, "Too few columns returned by SQL command selecting issue supporter in admission state.\n");
-        err = 1;
-        PQclear(res2);
-      } else {
-        if (process_area_or_unit(db, res2, escaped_area_id, "area")) err = 1;
-        PQclear(res2);
-      }
-      freemem(escaped_area_id);
-    }
-    PQclear(res);
+  // use replica for reading input data, if given:
+  db_read = db;
+  if (replica_conninfo) {
+    PGconn *replica = connect_replica(db, replica_conninfo);
+    if (replica) db_read = replica;
   }
 
-  // go through units:
-  res = PQexec(db, "SELECT \"id\" FROM \"unit\"");
-  if (!res) {
-    fprintf(stderr, "Error in pqlib while sending SQL command selecting units to process.\n");
-    err = 1;
-  } else if (PQresultStatus(res) != PGRES_TUPLES_OK) {
-    fprintf(stderr, "Error while executing SQL command selecting units to process:\n%s", PQresultErrorMessage(res));
-    err = 1;
-    PQclear(res);
-  } else if (PQnfields(res) < 1) {
-    fprintf(stderr, "Too few columns returned by SQL command selecting units to process.\n");
-    err = 1;
-    PQclear(res);
-  } else {
-    count = PQntuples(res);
-    if (logging) printf("Number of units to process: %i\n", count);
-    for (i=0; i<count; i++) {
-      char *unit_id, *escaped_unit_id;
-      char *cmd;
-      PGresult *res2;
-      unit_id = PQgetvalue(res, i, 0);
-      if (logging) printf("Processing unit #%s:\n", unit_id);
-      escaped_unit_id = escapeLiteral(db, unit_id, strlen(unit_id));
-      if (!escaped_unit_id) {
-        fprintf(stderr, "Could not escape literal in memory.\n");
-        abort();
-      }
-      if (asprintf(&cmd, "SELECT \"member_id\", \"weight\", \"issue_id\" FROM \"issue_supporter_in_admission_state\" WHERE \"unit_id\" = %s ORDER BY \"member_id\"", escaped_unit_id) < 0) {
-        fprintf(stderr, "Could not prepare query string in memory.\n");
-        abort();
-      }
-      res2 = PQexec(db, cmd);
-      free(cmd);
-      if (!res2) {
-        fprintf(stderr, "Error in pqlib while sending SQL command selecting issue supporter in admission state.\n");
-        err = 1;
-      } else if (PQresultStatus(res2) != PGRES_TUPLES_OK) {
-        fprintf(stderr, "Error while executing SQL command selecting issue supporter in admission state:\n%s", PQresultErrorMessage(res));
-        err = 1;
-        PQclear(res2);
-      } else if (PQnfields(res2) < 3) {
-        fprintf(stderr, "Too few columns returned by SQL command selecting issue supporter in admission state.\n");
-        err = 1;
-        PQclear(res2);
-      } else {
-        if (process_area_or_unit(db, res2, escaped_unit_id, "unit")) err = 1;
-        PQclear(res2);
-      }
-      freemem(escaped_unit_id);
-    }
-    PQclear(res);
-  }
+  // calculate and write ordering of issues:
+  if (lf_update_issue_order(db, db_read)) err = 1;
 
-  // clean-up entries of deleted issues
-  res = PQexec(db, "DELETE FROM \"issue_order_in_admission_state\" USING \"issue_order_in_admission_state\" AS \"self\" NATURAL LEFT JOIN \"issue\" WHERE \"issue_order_in_admission_state\".\"id\" = \"self\".\"id\" AND (\"issue\".\"id\" ISNULL OR \"issue\".\"state\" != 'admission'::\"issue_state\")");
-  if (!res) {
-    fprintf(stderr, "Error in pqlib while sending SQL command deleting ordering data of deleted issues.\n");
-    err = 1;
-  } else if (
-    PQresultStatus(res) != PGRES_COMMAND_OK &&
-    PQresultStatus(res) != PGRES_TUPLES_OK
-  ) {
-    fprintf(stderr, "Error while executing SQL command deleting ordering data of deleted issues:\n%s", PQresultErrorMessage(res));
+  // cleanup and exit:
+  if (capture_file && fclose(capture_file)) {
+    fprintf(stderr, "Error while closing capture file.\n");
     err = 1;
-    PQclear(res);
-  } else {
-    if (logging) printf("Cleaned up ordering data of %s deleted issues.\n", PQcmdTuples(res));
-    PQclear(res);
   }
-
-  // cleanup and exit:
+  if (db_read != db) PQfinish(db_read);
   PQfinish(db);
+  if (metrics_filename && write_metrics(metrics_filename, err, &run_start)) err = 1;
   if (!err) {
     if (logging) printf("Successfully terminated.\n");
   } else {
@@ -591,3 +1157,5 @@ int main(int argc, char **argv) {
   return err;
 
 }
+
+#endif
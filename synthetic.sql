@@ -0,0 +1,406 @@
+-- NOTE: This file requires that sequence generators have not been used.
+-- (All new rows need to start with id '1'.)
+
+-- Generates a synthetic dataset for benchmarking, e.g. ten times the
+-- size of the demo (100 members per unit of scale) with random seed 1:
+-- $ psql -v ON_ERROR_STOP=1 -v scale=10 -v seed=1 -f synthetic.sql DATABASE_NAME
+-- The same scale and seed always result in the same data (except for
+-- timestamps). All random values are derived from the seed with md5(),
+-- such that they do not depend on the order in which rows are processed.
+-- Issues are created in admission and pass through all phases by calling
+-- "check_everything"() while moving their timestamps into the past.
+
+\if :{?scale}
+\else
+  \set scale 1
+\endif
+\if :{?seed}
+\else
+  \set seed 1
+\endif
+
+SET "synthetic.scale" = :'scale';
+SET "synthetic.seed" = :'seed';
+
+-- uniformly distributed pseudo random value in [0, 1) for a given key:
+CREATE FUNCTION pg_temp."rnd"(TEXT) RETURNS FLOAT8
+  LANGUAGE SQL STABLE AS $$ SELECT
+    ( 'x' || substr(
+        md5(current_setting('synthetic.seed') || '-' || $1), 1, 13
+      ) )::BIT(52)::INT8::FLOAT8 / 4503599627370496::FLOAT8
+  $$;
+
+-- given number multiplied by scale:
+CREATE FUNCTION pg_temp."scaled"(INT4) RETURNS INT4
+  LANGUAGE SQL STABLE AS $$ SELECT
+    $1 * current_setting('synthetic.scale')::INT4
+  $$;
+
+-- member id where low ids are chosen more often (power-law):
+CREATE FUNCTION pg_temp."popular_member"(TEXT, FLOAT8) RETURNS INT4
+  LANGUAGE SQL STABLE AS $$ SELECT
+    1 + floor(pg_temp."scaled"(100) * pg_temp."rnd"($1) ^ $2)::INT4
+  $$;
+
+-- sample from a Pareto distribution with minimum 1 and given exponent:
+CREATE FUNCTION pg_temp."pareto"(TEXT, FLOAT8) RETURNS INT4
+  LANGUAGE SQL STABLE AS $$ SELECT
+    floor((1 - pg_temp."rnd"($1)) ^ (-1 / $2))::INT4
+  $$;
+
+BEGIN;
+
+INSERT INTO "system_setting" ("member_ttl") VALUES ('31 days');
+
+INSERT INTO "policy" (
+    "index",
+    "name",
+    "min_admission_time", "max_admission_time",
+    "discussion_time", "verification_time", "voting_time",
+    "issue_quorum", "issue_quorum_num", "issue_quorum_den",
+    "initiative_quorum", "initiative_quorum_num", "initiative_quorum_den"
+  ) VALUES (
+    1,
+    'synthetic',
+    '0', '7 days',
+    '15 days', '8 days', '15 days',
+    1, 1, 100,
+    1, 5, 100
+  );
+
+-- units form a random tree below unit 1:
+INSERT INTO "unit" ("id", "parent_id", "name")
+  SELECT
+    "n",
+    CASE WHEN "n" > 1 THEN
+      1 + floor(pg_temp."rnd"('unit-' || "n") * ("n" - 1))::INT4
+    END,
+    'Unit #' || "n"
+  FROM generate_series(1, pg_temp."scaled"(5)) AS "n";
+
+INSERT INTO "area" ("id", "unit_id", "name")
+  SELECT
+    "n",
+    1 + floor(pg_temp."rnd"('area-' || "n") * pg_temp."scaled"(5))::INT4,
+    'Area #' || "n"
+  FROM generate_series(1, pg_temp."scaled"(17)) AS "n";
+
+INSERT INTO "allowed_policy" ("area_id", "policy_id", "default_policy")
+  SELECT "id", 1, TRUE FROM "area";
+
+INSERT INTO "member" (
+    "id", "activated", "last_activity", "active", "login", "name",
+    "notify_email", "notification_hour"
+  ) SELECT
+    "n", now(), now(), TRUE, 'user' || "n", 'User #' || "n",
+    'user' || "n" || '@example.org',
+    floor(pg_temp."rnd"('notification-' || "n") * 24)::INT4
+  FROM generate_series(1, pg_temp."scaled"(100)) AS "n";
+
+-- every member has voting rights in unit 1 and in two random units:
+INSERT INTO "privilege" ("unit_id", "member_id")
+  SELECT 1, "id" FROM "member";
+INSERT INTO "privilege" ("unit_id", "member_id")
+  SELECT
+    1 + floor(
+      pg_temp."rnd"('privilege-' || "member"."id" || '-' || "k") *
+      pg_temp."scaled"(5)
+    )::INT4,
+    "member"."id"
+  FROM "member", generate_series(1, 2) AS "k"
+  ON CONFLICT DO NOTHING;
+
+-- unit delegations: members 10, 11, and 12 (modulo 100) form a cycle,
+-- members 20 and 21 (modulo 100) delegate to each other, and a fifth of
+-- the other members delegate to popular members (resulting in chains):
+INSERT INTO "delegation" ("truster_id", "trustee_id", "scope", "unit_id")
+  SELECT * FROM (
+    SELECT
+      "id" AS "truster_id",
+      CASE
+        WHEN "id" % 100 IN (10, 11) THEN "id" + 1
+        WHEN "id" % 100 = 12 THEN "id" - 2
+        WHEN "id" % 100 = 20 THEN "id" + 1
+        WHEN "id" % 100 = 21 THEN "id" - 1
+        ELSE pg_temp."popular_member"('delegation-' || "id", 3)
+      END AS "trustee_id",
+      'unit'::"delegation_scope",
+      1
+    FROM "member"
+    WHERE "id" % 100 IN (10, 11, 12, 20, 21)
+    OR pg_temp."rnd"('unit-delegation-' || "id") < 0.2
+  ) AS "subquery"
+  WHERE "truster_id" != "trustee_id";
+
+-- area delegations (a tenth of them abstentions from unit delegation):
+INSERT INTO "delegation" ("truster_id", "trustee_id", "scope", "area_id")
+  SELECT * FROM (
+    SELECT
+      "id" AS "truster_id",
+      CASE WHEN pg_temp."rnd"('area-abstention-' || "id") >= 0.1 THEN
+        pg_temp."popular_member"('area-delegation-trustee-' || "id", 3)
+      END AS "trustee_id",
+      'area'::"delegation_scope",
+      1 + floor(
+        pg_temp."rnd"('area-delegation-area-' || "id") * pg_temp."scaled"(17)
+      )::INT4
+    FROM "member"
+    WHERE pg_temp."rnd"('area-delegation-' || "id") < 0.1
+  ) AS "subquery"
+  WHERE "truster_id" IS DISTINCT FROM "trustee_id";
+
+-- state into which each issue is brought:
+CREATE TEMPORARY TABLE "synthetic_issue" AS
+  SELECT
+    "n" AS "id",
+    1 + floor(
+      pg_temp."rnd"('issue-area-' || "n") ^ 1.3 * pg_temp."scaled"(17)
+    )::INT4 AS "area_id",
+    CASE
+      WHEN "r" < 0.20 THEN 'admission'
+      WHEN "r" < 0.23 THEN 'revoked'
+      WHEN "r" < 0.25 THEN 'canceled_by_admin'
+      WHEN "r" < 0.40 THEN 'discussion'
+      WHEN "r" < 0.50 THEN 'verification'
+      WHEN "r" < 0.65 THEN 'voting'
+      ELSE 'closed'
+    END AS "target"
+  FROM (
+    SELECT "n", pg_temp."rnd"('issue-target-' || "n") AS "r"
+    FROM generate_series(1, pg_temp."scaled"(40)) AS "n"
+  ) AS "subquery";
+
+CREATE TEMPORARY TABLE "synthetic_initiative" AS
+  SELECT
+    row_number() OVER (ORDER BY "synthetic_issue"."id", "k")::INT4 AS "id",
+    "synthetic_issue"."id" AS "issue_id",
+    pg_temp."popular_member"(
+      'initiator-' || "synthetic_issue"."id" || '-' || "k", 2
+    ) AS "author_id"
+  FROM "synthetic_issue"
+  CROSS JOIN generate_series(1, least(8,
+    1 + floor(-ln(1 - pg_temp."rnd"('initiatives-' || "synthetic_issue"."id")) * 1.2)::INT4
+  )) AS "k";
+
+-- issues which shall stay in admission can't be admitted yet:
+INSERT INTO "issue" (
+    "id", "area_id", "policy_id", "min_admission_time", "max_admission_time"
+  ) SELECT
+    "id", "area_id", 1,
+    CASE WHEN "target" = 'admission' THEN '30 days'::INTERVAL END,
+    CASE WHEN "target" = 'admission' THEN '60 days'::INTERVAL END
+  FROM "synthetic_issue";
+
+INSERT INTO "initiative" ("id", "issue_id", "name")
+  SELECT "id", "issue_id", 'Initiative #' || "id"
+  FROM "synthetic_initiative";
+
+INSERT INTO "initiator" ("initiative_id", "member_id", "accepted")
+  SELECT "id", "author_id", TRUE FROM "synthetic_initiative";
+
+INSERT INTO "draft" ("id", "initiative_id", "author_id", "content")
+  SELECT "id", "id", "author_id", 'Draft of initiative #' || "id"
+  FROM "synthetic_initiative";
+
+-- supporters per initiative follow a power-law distribution, and
+-- popular members support more often:
+INSERT INTO "supporter" ("initiative_id", "member_id")
+  SELECT "synthetic_initiative"."id", "synthetic_initiative"."author_id"
+  FROM "synthetic_initiative";
+INSERT INTO "supporter" ("initiative_id", "member_id")
+  SELECT "synthetic_initiative"."id", "privilege"."member_id"
+  FROM "synthetic_initiative"
+  JOIN "issue" ON "issue"."id" = "synthetic_initiative"."issue_id"
+  JOIN "area" ON "area"."id" = "issue"."area_id"
+  CROSS JOIN generate_series(1, least(pg_temp."scaled"(50),
+    pg_temp."pareto"('supporters-' || "synthetic_initiative"."id", 0.8)
+  )) AS "k"
+  JOIN "privilege" ON
+    "privilege"."unit_id" = "area"."unit_id" AND
+    "privilege"."member_id" = pg_temp."popular_member"(
+      'supporter-' || "synthetic_initiative"."id" || '-' || "k", 1.5 )
+  ON CONFLICT DO NOTHING;
+
+CREATE TEMPORARY TABLE "synthetic_suggestion" AS
+  SELECT
+    row_number() OVER (ORDER BY "synthetic_initiative"."id", "k")::INT8 AS "id",
+    "synthetic_initiative"."id" AS "initiative_id",
+    pg_temp."popular_member"(
+      'suggestion-author-' || "synthetic_initiative"."id" || '-' || "k", 2
+    ) AS "author_id"
+  FROM "synthetic_initiative"
+  CROSS JOIN generate_series(1, least(20,
+    pg_temp."pareto"('suggestions-' || "synthetic_initiative"."id", 1.2) - 1
+  )) AS "k";
+
+INSERT INTO "suggestion" ("id", "initiative_id", "author_id", "name", "content")
+  SELECT "id", "initiative_id", "author_id", 'Suggestion #' || "id", ''
+  FROM "synthetic_suggestion";
+
+INSERT INTO "opinion" ("suggestion_id", "member_id", "degree")
+  SELECT "id", "author_id", 2 FROM "synthetic_suggestion";
+INSERT INTO "opinion" ("suggestion_id", "member_id", "degree", "fulfilled")
+  SELECT
+    "synthetic_suggestion"."id",
+    "supporter"."member_id",
+    (ARRAY[-2, -1, 1, 2])[1 + floor(4 * pg_temp."rnd"(
+      'degree-' || "synthetic_suggestion"."id" || '-' || "supporter"."member_id"
+    ))::INT4],
+    pg_temp."rnd"(
+      'fulfilled-' || "synthetic_suggestion"."id" || '-' || "supporter"."member_id"
+    ) < 0.3
+  FROM "synthetic_suggestion"
+  JOIN "supporter" ON
+    "supporter"."initiative_id" = "synthetic_suggestion"."initiative_id"
+  WHERE pg_temp."rnd"(
+    'opinion-' || "synthetic_suggestion"."id" || '-' || "supporter"."member_id"
+  ) < 0.3
+  ON CONFLICT DO NOTHING;
+
+SELECT setval(pg_get_serial_sequence('"unit"', 'id'), max("id")) FROM "unit";
+SELECT setval(pg_get_serial_sequence('"area"', 'id'), max("id")) FROM "area";
+SELECT setval(pg_get_serial_sequence('"member"', 'id'), max("id")) FROM "member";
+SELECT setval(pg_get_serial_sequence('"issue"', 'id'), max("id")) FROM "issue";
+SELECT setval(pg_get_serial_sequence('"initiative"', 'id'), max("id")) FROM "initiative";
+SELECT setval(pg_get_serial_sequence('"draft"', 'id'), max("id")) FROM "draft";
+SELECT setval(pg_get_serial_sequence('"suggestion"', 'id'), max("id")) FROM "suggestion";
+
+-- a fifth of the initiatives get a second draft after being supported:
+INSERT INTO "draft" ("initiative_id", "author_id", "content")
+  SELECT "id", "author_id", 'Second draft of initiative #' || "id"
+  FROM "synthetic_initiative"
+  WHERE pg_temp."rnd"('second-draft-' || "id") < 0.2
+  ORDER BY "id";
+
+-- issue delegations for some issues:
+INSERT INTO "delegation" ("truster_id", "trustee_id", "scope", "issue_id")
+  SELECT * FROM (
+    SELECT
+      pg_temp."popular_member"(
+        'issue-delegation-truster-' || "id" || '-' || "k", 1
+      ) AS "truster_id",
+      pg_temp."popular_member"(
+        'issue-delegation-trustee-' || "id" || '-' || "k", 3
+      ) AS "trustee_id",
+      'issue'::"delegation_scope",
+      "id"
+    FROM "synthetic_issue", generate_series(1, 3) AS "k"
+    WHERE "target" IN ('discussion', 'verification', 'voting', 'closed')
+  ) AS "subquery"
+  WHERE "truster_id" != "trustee_id"
+  ON CONFLICT DO NOTHING;
+
+COMMIT;
+
+BEGIN;
+
+UPDATE "initiative" SET
+  "revoked" = now(),
+  "revoked_by_member_id" = "synthetic_initiative"."author_id"
+  FROM "synthetic_initiative", "synthetic_issue"
+  WHERE "synthetic_initiative"."id" = "initiative"."id"
+  AND "synthetic_issue"."id" = "synthetic_initiative"."issue_id"
+  AND "synthetic_issue"."target" = 'revoked';
+
+UPDATE "issue" SET "state" = 'canceled_by_admin', "closed" = now()
+  FROM "synthetic_issue"
+  WHERE "synthetic_issue"."id" = "issue"."id"
+  AND "synthetic_issue"."target" = 'canceled_by_admin';
+
+COMMIT;
+
+-- moves the timestamps of open issues into the past, such that the
+-- current phase ends (unless the issue already is in its target state):
+CREATE FUNCTION pg_temp."travel"() RETURNS VOID
+  LANGUAGE SQL VOLATILE AS $$
+    UPDATE "issue" SET
+      "created"      = "created"      - "subquery"."shift",
+      "accepted"     = "accepted"     - "subquery"."shift",
+      "half_frozen"  = "half_frozen"  - "subquery"."shift",
+      "fully_frozen" = "fully_frozen" - "subquery"."shift"
+    FROM (
+      SELECT
+        "issue"."id",
+        CASE "issue"."state"
+          WHEN 'admission'    THEN "issue"."max_admission_time"
+          WHEN 'discussion'   THEN "issue"."discussion_time"
+          WHEN 'verification' THEN "issue"."verification_time"
+          WHEN 'voting'       THEN "issue"."voting_time"
+        END + '1 second'::INTERVAL AS "shift"
+      FROM "issue" JOIN "synthetic_issue" USING ("id")
+      WHERE
+        array_position(
+          ARRAY['admission', 'discussion', 'verification', 'voting', 'closed'],
+          "synthetic_issue"."target" ) >
+        array_position(
+          ARRAY['admission', 'discussion', 'verification', 'voting'],
+          "issue"."state"::TEXT )
+    ) AS "subquery"
+    WHERE "issue"."id" = "subquery"."id";
+  $$;
+
+BEGIN ISOLATION LEVEL REPEATABLE READ;
+SELECT "check_everything"();
+COMMIT;
+
+BEGIN ISOLATION LEVEL REPEATABLE READ;
+SELECT pg_temp."travel"();
+SELECT "check_everything"();
+COMMIT;
+
+BEGIN ISOLATION LEVEL REPEATABLE READ;
+SELECT pg_temp."travel"();
+SELECT "check_everything"();
+COMMIT;
+
+BEGIN;
+
+-- most interested members and some other members vote:
+INSERT INTO "direct_voter" ("issue_id", "member_id")
+  SELECT "interest"."issue_id", "interest"."member_id"
+  FROM "interest"
+  JOIN "issue" ON "issue"."id" = "interest"."issue_id"
+  JOIN "area" ON "area"."id" = "issue"."area_id"
+  JOIN "privilege" ON
+    "privilege"."unit_id" = "area"."unit_id" AND
+    "privilege"."member_id" = "interest"."member_id"
+  WHERE "issue"."state" = 'voting'
+  AND pg_temp."rnd"(
+    'voter-' || "interest"."issue_id" || '-' || "interest"."member_id"
+  ) < 0.8;
+INSERT INTO "direct_voter" ("issue_id", "member_id")
+  SELECT "issue"."id", "privilege"."member_id"
+  FROM "issue"
+  JOIN "area" ON "area"."id" = "issue"."area_id"
+  CROSS JOIN generate_series(1, pg_temp."scaled"(2)) AS "k"
+  JOIN "privilege" ON
+    "privilege"."unit_id" = "area"."unit_id" AND
+    "privilege"."member_id" = pg_temp."popular_member"(
+      'other-voter-' || "issue"."id" || '-' || "k", 1 )
+  WHERE "issue"."state" = 'voting'
+  ON CONFLICT DO NOTHING;
+
+INSERT INTO "vote" ("initiative_id", "member_id", "grade")
+  SELECT * FROM (
+    SELECT
+      "initiative"."id",
+      "direct_voter"."member_id",
+      floor(5 * pg_temp."rnd"(
+        'grade-' || "initiative"."id" || '-' || "direct_voter"."member_id"
+      ))::INT4 - 2 AS "grade"
+    FROM "direct_voter"
+    JOIN "issue" ON "issue"."id" = "direct_voter"."issue_id"
+    JOIN "initiative" ON "initiative"."issue_id" = "issue"."id"
+    WHERE "issue"."state" = 'voting'
+    AND "initiative"."admitted"
+  ) AS "subquery"
+  WHERE "grade" != 0;
+
+COMMIT;
+
+BEGIN ISOLATION LEVEL REPEATABLE READ;
+SELECT pg_temp."travel"();
+SELECT "check_everything"();
+COMMIT;
+
+SELECT "state", count(1) FROM "issue" GROUP BY "state" ORDER BY "state";
@@ -0,0 +1,4457 @@
+BEGIN;
+
+CREATE OR REPLACE VIEW "liquid_feedback_version" AS
+  SELECT * FROM (VALUES ('4.3.0', 4, 3, 0))
+  AS "subquery"("string", "major", "minor", "revision");
+
+CREATE VIEW "garbage_collection_backlog" AS
+  SELECT
+    (SELECT count(1) FROM "expired_session") AS "expired_session_count",
+    (SELECT count(1) FROM "expired_token")   AS "expired_token_count",
+    (SELECT count(1) FROM "unused_snapshot") AS "unused_snapshot_count";
+
+COMMENT ON VIEW "garbage_collection_backlog" IS 'Number of rows which are waiting to be deleted by the garbage collection of "lf_update"; "lf_update" deletes these rows in batches with a limited budget per run, so non-zero values which persist over several runs indicate that the budget is too small';
+
+DROP TRIGGER "send_notify" ON "event";
+
+CREATE OR REPLACE FUNCTION "send_event_notify_trigger"()
+  RETURNS TRIGGER
+  LANGUAGE 'plpgsql' VOLATILE AS $$
+    BEGIN
+      PERFORM pg_notify('event', "event"::TEXT)
+        FROM (SELECT DISTINCT "event" FROM "new_event") AS "subquery";
+      RETURN NULL;
+    END;
+  $$;
+
+CREATE TRIGGER "send_notify"
+  AFTER INSERT ON "event" REFERENCING NEW TABLE AS "new_event"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "send_event_notify_trigger"();
+
+CREATE TRIGGER "send_notify_on_update"
+  AFTER UPDATE ON "event" REFERENCING NEW TABLE AS "new_event"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "send_event_notify_trigger"();
+
+COMMENT ON FUNCTION "send_event_notify_trigger"()       IS 'Implementation of triggers "send_notify" and "send_notify_on_update" on table "event"';
+COMMENT ON TRIGGER "send_notify"           ON "event" IS 'Sends a NOTIFY on channel "event" with the event type as payload, once for each distinct event type inserted by a statement';
+COMMENT ON TRIGGER "send_notify_on_update" ON "event" IS 'Sends a NOTIFY on channel "event" with the event type as payload, once for each distinct event type updated by a statement';
+
+CREATE FUNCTION "get_events_for_notification"
+  ( "event_count_p" INT4 )
+  RETURNS SETOF "event_for_notification"
+  LANGUAGE 'plpgsql' VOLATILE AS $$
+    DECLARE
+      "processed_event_id_v"   "event"."id"%TYPE;
+      "processed_occurrence_v" "event"."occurrence"%TYPE;
+      "min_occurrence_v"       "event"."occurrence"%TYPE;
+      "last_event_id_v"        "event"."id"%TYPE;
+      "last_occurrence_v"      "event"."occurrence"%TYPE;
+    BEGIN
+      PERFORM "require_transaction_isolation"();
+      SELECT "event_id", "occurrence"
+        INTO "processed_event_id_v", "processed_occurrence_v"
+        FROM "event_processed" FOR UPDATE;
+      IF NOT FOUND THEN
+        SELECT "id", "occurrence"
+          INTO "processed_event_id_v", "processed_occurrence_v"
+          FROM "event" ORDER BY "id" DESC LIMIT 1;
+        INSERT INTO "event_processed" ("event_id", "occurrence") VALUES (
+          COALESCE("processed_event_id_v", 0), "processed_occurrence_v" );
+        RETURN;
+      END IF;
+      -- events are written with the time of their transaction, which may
+      -- commit later than transactions writing subsequent events; hence a
+      -- margin is subtracted when excluding partitions by "occurrence":
+      "min_occurrence_v" := COALESCE(
+        "processed_occurrence_v" - '1 day'::INTERVAL, '-infinity' );
+      SELECT "id", "occurrence"
+        INTO "last_event_id_v", "last_occurrence_v"
+        FROM (
+          SELECT "id", "occurrence" FROM "event"
+          WHERE "id" > "processed_event_id_v"
+          AND "occurrence" >= "min_occurrence_v"
+          ORDER BY "id" LIMIT "event_count_p"
+        ) AS "subquery"
+        ORDER BY "id" DESC LIMIT 1;
+      IF "last_event_id_v" ISNULL THEN
+        RETURN;
+      END IF;
+      UPDATE "event_processed" SET
+        "event_id" = "last_event_id_v",
+        "occurrence" = "last_occurrence_v";
+      RETURN QUERY SELECT
+        "candidate"."member_id" AS "recipient_id",
+        "event".*
+      FROM "event"
+      JOIN "issue" ON "issue"."id" = "event"."issue_id"
+      JOIN "area" ON "area"."id" = "issue"."area_id"
+      JOIN LATERAL (
+        SELECT "privilege"."member_id" FROM "privilege"
+        WHERE "privilege"."unit_id" = "area"."unit_id"
+        AND "privilege"."voting_right"
+        UNION
+        SELECT "issue_privilege"."member_id" FROM "issue_privilege"
+        WHERE "issue_privilege"."issue_id" = "event"."issue_id"
+        AND "issue_privilege"."voting_right"
+        UNION
+        SELECT "subscription"."member_id" FROM "subscription"
+        WHERE "subscription"."unit_id" = "area"."unit_id"
+      ) AS "candidate" ON TRUE
+      LEFT JOIN "privilege" ON
+        "privilege"."member_id" = "candidate"."member_id" AND
+        "privilege"."unit_id" = "area"."unit_id"
+      LEFT JOIN "issue_privilege" ON
+        "issue_privilege"."member_id" = "candidate"."member_id" AND
+        "issue_privilege"."issue_id" = "event"."issue_id"
+      LEFT JOIN "subscription" ON
+        "subscription"."member_id" = "candidate"."member_id" AND
+        "subscription"."unit_id" = "area"."unit_id"
+      LEFT JOIN "ignored_area" ON
+        "ignored_area"."member_id" = "candidate"."member_id" AND
+        "ignored_area"."area_id" = "issue"."area_id"
+      LEFT JOIN "interest" ON
+        "interest"."member_id" = "candidate"."member_id" AND
+        "interest"."issue_id" = "event"."issue_id"
+      LEFT JOIN "supporter" ON
+        "supporter"."member_id" = "candidate"."member_id" AND
+        "supporter"."initiative_id" = "event"."initiative_id"
+      WHERE "event"."id" > "processed_event_id_v"
+      AND "event"."id" <= "last_event_id_v"
+      AND "event"."occurrence" >= "min_occurrence_v"
+      AND (
+        COALESCE("issue_privilege"."voting_right", "privilege"."voting_right") OR
+        "subscription"."member_id" NOTNULL
+      ) AND ("ignored_area"."member_id" ISNULL OR "interest"."member_id" NOTNULL)
+      AND (
+        "event"."event" = 'issue_state_changed'::"event_type" OR
+        ( "event"."event" = 'initiative_revoked'::"event_type" AND
+          "supporter"."member_id" NOTNULL ) )
+      ORDER BY "candidate"."member_id", "event"."id";
+      RETURN;
+    END;
+  $$;
+
+COMMENT ON FUNCTION "get_events_for_notification"
+  ( INT4 )
+  IS 'Returns the rows of view "event_for_notification" for the next (at most) given number of events after the one stored in "event_processed" (ordered by recipient, such that one digest per recipient can be created), and advances "event_processed" accordingly; Recipients are determined for all members at once, starting from the members with privileges or subscriptions in the respective units, instead of evaluating the view for each member; Only partitions of table "event" containing events after the processed one (with a margin of one day) are accessed; If "event_processed" is empty, it is initialized with the latest event and no rows are returned';
+
+ALTER TABLE "newsletter" ADD COLUMN "expanded" TIMESTAMPTZ;
+
+COMMENT ON COLUMN "newsletter"."expanded"            IS 'Timestamp when the recipients of the newsletter have been inserted into table "newsletter_recipient" (see function "expand_newsletter_recipients")';
+
+CREATE TABLE "newsletter_recipient" (
+        PRIMARY KEY ("newsletter_id", "member_id"),
+        "newsletter_id"         INT4            REFERENCES "newsletter" ("id") ON DELETE CASCADE ON UPDATE CASCADE,
+        "member_id"             INT4            REFERENCES "member" ("id") ON DELETE CASCADE ON UPDATE CASCADE );
+CREATE INDEX "newsletter_recipient_member_id_idx" ON "newsletter_recipient" ("member_id");
+
+COMMENT ON TABLE "newsletter_recipient" IS 'Delivery queue of newsletters: Recipients of a newsletter are inserted once by function "expand_newsletter_recipients" when the newsletter is published, and removed by function "newsletter_recipients_sent" after delivery (or all at once by trigger "newsletter_sent" when column "sent" of the newsletter is set); A mailer may fetch recipients in batches ordered by "member_id" (keyset pagination), such that delivery can be resumed after interruption';
+
+CREATE OR REPLACE VIEW "newsletter_to_send" AS
+  SELECT
+    "newsletter_recipient"."member_id" AS "recipient_id",
+    "newsletter"."id" AS "newsletter_id",
+    "newsletter"."published"
+  FROM "newsletter_recipient"
+  JOIN "newsletter" ON "newsletter"."id" = "newsletter_recipient"."newsletter_id"
+  WHERE "newsletter"."sent" ISNULL;
+
+COMMENT ON VIEW "newsletter_to_send" IS 'List of "newsletter_id"s for each member that are due to be sent out (reads the "newsletter_recipient" table, which is filled by function "expand_newsletter_recipients")';
+
+CREATE FUNCTION "expand_newsletter_recipients"()
+  RETURNS INT4
+  LANGUAGE 'plpgsql' VOLATILE AS $$
+    DECLARE
+      "newsletter_ids_v" INT4[];  -- "newsletter"."id"%TYPE[]
+    BEGIN
+      PERFORM "dont_require_transaction_isolation"();
+      SELECT array_agg("id") INTO "newsletter_ids_v" FROM (
+        SELECT "id" FROM "newsletter"
+        WHERE "published" <= now()
+        AND "sent" ISNULL
+        AND "expanded" ISNULL
+        FOR UPDATE
+      ) AS "subquery";
+      IF "newsletter_ids_v" ISNULL THEN
+        RETURN 0;
+      END IF;
+      INSERT INTO "newsletter_recipient" ("newsletter_id", "member_id")
+        SELECT "newsletter"."id", "member"."id"
+        FROM "newsletter" CROSS JOIN "member_eligible_to_be_notified" AS "member"
+        LEFT JOIN "privilege" ON
+          "privilege"."member_id" = "member"."id" AND
+          "privilege"."unit_id" = "newsletter"."unit_id" AND
+          "privilege"."voting_right" = TRUE
+        LEFT JOIN "subscription" ON
+          "subscription"."member_id" = "member"."id" AND
+          "subscription"."unit_id" = "newsletter"."unit_id"
+        WHERE "newsletter"."id" = ANY("newsletter_ids_v")
+        AND (
+          "member"."disable_notifications" = FALSE OR
+          "newsletter"."include_all_members" = TRUE )
+        AND (
+          "newsletter"."unit_id" ISNULL OR
+          "privilege"."member_id" NOTNULL OR
+          "subscription"."member_id" NOTNULL )
+        ON CONFLICT DO NOTHING;
+      UPDATE "newsletter" SET "expanded" = now()
+        WHERE "id" = ANY("newsletter_ids_v");
+      UPDATE "newsletter" SET "sent" = now()
+        WHERE "id" = ANY("newsletter_ids_v")
+        AND NOT EXISTS (
+          SELECT NULL FROM "newsletter_recipient"
+          WHERE "newsletter_recipient"."newsletter_id" = "newsletter"."id" );
+      RETURN array_length("newsletter_ids_v", 1);
+    END;
+  $$;
+
+COMMENT ON FUNCTION "expand_newsletter_recipients"() IS 'Determines the recipients of all published newsletters which have not been expanded yet and inserts them into the "newsletter_recipient" table (called by "lf_update"); Returns the number of expanded newsletters';
+
+
+CREATE FUNCTION "newsletter_recipients_sent"
+  ( "newsletter_id_p" "newsletter"."id"%TYPE,
+    "member_ids_p"    INT4[] )
+  RETURNS BOOLEAN
+  LANGUAGE 'plpgsql' VOLATILE AS $$
+    BEGIN
+      DELETE FROM "newsletter_recipient"
+        WHERE "newsletter_id" = "newsletter_id_p"
+        AND "member_id" = ANY("member_ids_p");
+      PERFORM NULL FROM "newsletter_recipient"
+        WHERE "newsletter_id" = "newsletter_id_p" LIMIT 1;
+      IF FOUND THEN
+        RETURN FALSE;
+      END IF;
+      UPDATE "newsletter" SET "sent" = now()
+        WHERE "id" = "newsletter_id_p" AND "sent" ISNULL;
+      RETURN TRUE;
+    END;
+  $$;
+
+COMMENT ON FUNCTION "newsletter_recipients_sent"
+  ( "newsletter"."id"%TYPE, INT4[] )
+  IS 'Acknowledges delivery of a newsletter to a batch of recipients by removing them from the "newsletter_recipient" table; When no recipients are left, column "sent" of the newsletter is set and TRUE is returned';
+
+
+CREATE FUNCTION "newsletter_sent_trigger"()
+  RETURNS TRIGGER
+  LANGUAGE 'plpgsql' VOLATILE AS $$
+    BEGIN
+      DELETE FROM "newsletter_recipient" WHERE "newsletter_id" = NEW."id";
+      RETURN NULL;
+    END;
+  $$;
+
+CREATE TRIGGER "newsletter_sent"
+  AFTER UPDATE OF "sent" ON "newsletter" FOR EACH ROW
+  WHEN (OLD."sent" ISNULL AND NEW."sent" NOTNULL) EXECUTE PROCEDURE
+  "newsletter_sent_trigger"();
+
+COMMENT ON FUNCTION "newsletter_sent_trigger"()      IS 'Implementation of trigger "newsletter_sent" on table "newsletter"';
+COMMENT ON TRIGGER "newsletter_sent" ON "newsletter" IS 'Removes remaining recipients of a newsletter from the delivery queue when column "sent" is set (e.g. by a mailer which reads view "newsletter_to_send" and does not call function "newsletter_recipients_sent")';
+
+CREATE OR REPLACE FUNCTION "delete_member"("member_id_p" "member"."id"%TYPE)
+  RETURNS VOID
+  LANGUAGE 'plpgsql' VOLATILE AS $$
+    BEGIN
+      UPDATE "member" SET
+        "last_login"                   = NULL,
+        "last_delegation_check"        = NULL,
+        "login"                        = NULL,
+        "password"                     = NULL,
+        "authority"                    = NULL,
+        "authority_uid"                = NULL,
+        "authority_login"              = NULL,
+        "deleted"                      = coalesce("deleted", now()),
+        "locked"                       = TRUE,
+        "active"                       = FALSE,
+        "notify_email"                 = NULL,
+        "notify_email_unconfirmed"     = NULL,
+        "notify_email_secret"          = NULL,
+        "notify_email_secret_expiry"   = NULL,
+        "notify_email_lock_expiry"     = NULL,
+        "disable_notifications"        = TRUE,
+        "notification_counter"         = DEFAULT,
+        "notification_sample_size"     = 0,
+        "notification_dow"             = NULL,
+        "notification_hour"            = NULL,
+        "notification_sent"            = NULL,
+        "login_recovery_expiry"        = NULL,
+        "password_reset_secret"        = NULL,
+        "password_reset_secret_expiry" = NULL,
+        "location"                     = NULL
+        WHERE "id" = "member_id_p";
+      DELETE FROM "member_settings"    WHERE "member_id" = "member_id_p";
+      DELETE FROM "member_profile"     WHERE "member_id" = "member_id_p";
+      DELETE FROM "rendered_member_statement" WHERE "member_id" = "member_id_p";
+      DELETE FROM "member_image"       WHERE "member_id" = "member_id_p";
+      DELETE FROM "contact"            WHERE "member_id" = "member_id_p";
+      DELETE FROM "ignored_member"     WHERE "member_id" = "member_id_p";
+      DELETE FROM "session"            WHERE "member_id" = "member_id_p";
+      DELETE FROM "member_application" WHERE "member_id" = "member_id_p";
+      DELETE FROM "token"              WHERE "member_id" = "member_id_p";
+      DELETE FROM "subscription"       WHERE "member_id" = "member_id_p";
+      DELETE FROM "ignored_area"       WHERE "member_id" = "member_id_p";
+      DELETE FROM "ignored_initiative" WHERE "member_id" = "member_id_p";
+      DELETE FROM "delegation"         WHERE "truster_id" = "member_id_p";
+      DELETE FROM "non_voter"          WHERE "member_id" = "member_id_p";
+      DELETE FROM "direct_voter" USING "issue"
+        WHERE "direct_voter"."issue_id" = "issue"."id"
+        AND "issue"."closed" ISNULL
+        AND "member_id" = "member_id_p";
+      DELETE FROM "notification_initiative_sent" WHERE "member_id" = "member_id_p";
+      DELETE FROM "newsletter_recipient" WHERE "member_id" = "member_id_p";
+      RETURN;
+    END;
+  $$;
+
+COMMENT ON VIEW "member_eligible_to_be_notified" IS 'Filtered "member" table containing only activated and non-locked members (used as helper view for "member_to_notify" and function "expand_newsletter_recipients")';
+
+CREATE TABLE "member_contingent_counter" (
+        PRIMARY KEY ("member_id", "polling", "bucket"),
+        "member_id"             INT4            REFERENCES "member" ("id") ON DELETE CASCADE ON UPDATE CASCADE,
+        "polling"               BOOLEAN,
+        "bucket"                TIMESTAMPTZ,
+        "text_entry_count"      INT4            NOT NULL DEFAULT 0,
+        "initiative_count"      INT4            NOT NULL DEFAULT 0 );
+CREATE INDEX "member_contingent_counter_bucket_idx" ON "member_contingent_counter" ("bucket");
+
+COMMENT ON TABLE "member_contingent_counter" IS 'Number of drafts, suggestions, and initiatives created by a member per minute, maintained by triggers on tables "draft" and "suggestion", and used by view "member_contingent" instead of counting drafts and suggestions; Rows older than the longest time frame in table "contingent" are deleted by "lf_update" (see view "expired_member_contingent_counter")';
+
+COMMENT ON COLUMN "member_contingent_counter"."polling"          IS 'Copied from column "polling" of the initiative (always FALSE for suggestions, as suggestions only count for contingents with "polling" set to FALSE)';
+COMMENT ON COLUMN "member_contingent_counter"."bucket"           IS 'Creation time of the drafts and suggestions, truncated to the minute';
+COMMENT ON COLUMN "member_contingent_counter"."text_entry_count" IS 'Number of drafts and suggestions created within the minute';
+COMMENT ON COLUMN "member_contingent_counter"."initiative_count" IS 'Number of initiatives (i.e. opening drafts) created within the minute';
+
+CREATE FUNCTION "count_draft_for_contingent_trigger"()
+  RETURNS TRIGGER
+  LANGUAGE 'plpgsql' VOLATILE AS $$
+    DECLARE
+      "polling_v" "initiative"."polling"%TYPE;
+      "opening_v" BOOLEAN;
+    BEGIN
+      SELECT "polling" INTO "polling_v"
+        FROM "initiative" WHERE "id" = NEW."initiative_id";
+      "opening_v" := NOT EXISTS (
+        SELECT NULL FROM "draft"
+        WHERE "initiative_id" = NEW."initiative_id" AND "id" < NEW."id" );
+      INSERT INTO "member_contingent_counter"
+        ("member_id", "polling", "bucket", "text_entry_count", "initiative_count")
+        VALUES (
+          NEW."author_id",
+          "polling_v",
+          date_trunc('minute', NEW."created"),
+          1,
+          CASE WHEN "opening_v" THEN 1 ELSE 0 END )
+        ON CONFLICT ("member_id", "polling", "bucket") DO UPDATE SET
+          "text_entry_count" =
+            "member_contingent_counter"."text_entry_count" + 1,
+          "initiative_count" =
+            "member_contingent_counter"."initiative_count" +
+            EXCLUDED."initiative_count";
+      RETURN NULL;
+    END;
+  $$;
+
+CREATE TRIGGER "count_draft_for_contingent"
+  AFTER INSERT ON "draft" FOR EACH ROW EXECUTE PROCEDURE
+  "count_draft_for_contingent_trigger"();
+
+COMMENT ON FUNCTION "count_draft_for_contingent_trigger"()     IS 'Implementation of trigger "count_draft_for_contingent" on table "draft"';
+COMMENT ON TRIGGER "count_draft_for_contingent" ON "draft" IS 'Increments counters in table "member_contingent_counter" (counting the draft as text entry and, if it is the first draft of an initiative, as initiative); NOTE: Counters are not decremented when drafts are deleted';
+
+
+CREATE FUNCTION "count_suggestion_for_contingent_trigger"()
+  RETURNS TRIGGER
+  LANGUAGE 'plpgsql' VOLATILE AS $$
+    BEGIN
+      INSERT INTO "member_contingent_counter"
+        ("member_id", "polling", "bucket", "text_entry_count")
+        VALUES (
+          NEW."author_id",
+          FALSE,
+          date_trunc('minute', NEW."created"),
+          1 )
+        ON CONFLICT ("member_id", "polling", "bucket") DO UPDATE SET
+          "text_entry_count" =
+            "member_contingent_counter"."text_entry_count" + 1;
+      RETURN NULL;
+    END;
+  $$;
+
+CREATE TRIGGER "count_suggestion_for_contingent"
+  AFTER INSERT ON "suggestion" FOR EACH ROW EXECUTE PROCEDURE
+  "count_suggestion_for_contingent_trigger"();
+
+COMMENT ON FUNCTION "count_suggestion_for_contingent_trigger"()          IS 'Implementation of trigger "count_suggestion_for_contingent" on table "suggestion"';
+COMMENT ON TRIGGER "count_suggestion_for_contingent" ON "suggestion" IS 'Increments counters in table "member_contingent_counter" (counting the suggestion as text entry); NOTE: Counters are not decremented when suggestions are deleted';
+
+INSERT INTO "member_contingent_counter"
+  ("member_id", "polling", "bucket", "text_entry_count", "initiative_count")
+  SELECT
+    "author_id", "polling", "bucket",
+    count(1) AS "text_entry_count",
+    count(1) FILTER (WHERE "opening") AS "initiative_count"
+  FROM (
+    SELECT
+      "draft"."author_id",
+      "initiative"."polling",
+      date_trunc('minute', "draft"."created") AS "bucket",
+      NOT EXISTS (
+        SELECT NULL FROM "draft" AS "earlier_draft"
+        WHERE "earlier_draft"."initiative_id" = "draft"."initiative_id"
+        AND "earlier_draft"."id" < "draft"."id"
+      ) AS "opening"
+    FROM "draft" JOIN "initiative" ON "initiative"."id" = "draft"."initiative_id"
+    WHERE "draft"."created" > now() - '1 minute'::INTERVAL - (
+      SELECT COALESCE(max("time_frame"), '0'::INTERVAL) FROM "contingent" )
+    UNION ALL
+    SELECT
+      "author_id",
+      FALSE AS "polling",
+      date_trunc('minute', "created") AS "bucket",
+      FALSE AS "opening"
+    FROM "suggestion"
+    WHERE "created" > now() - '1 minute'::INTERVAL - (
+      SELECT COALESCE(max("time_frame"), '0'::INTERVAL) FROM "contingent" )
+  ) AS "subquery"
+  GROUP BY "author_id", "polling", "bucket";
+
+CREATE VIEW "expired_member_contingent_counter" AS
+  SELECT * FROM "member_contingent_counter"
+  WHERE "bucket" <= now() - '1 minute'::INTERVAL - (
+    SELECT COALESCE(max("time_frame"), '0'::INTERVAL) FROM "contingent" );
+
+CREATE RULE "delete" AS ON DELETE TO "expired_member_contingent_counter" DO INSTEAD
+  DELETE FROM "member_contingent_counter"
+  WHERE "member_id" = OLD."member_id"
+  AND "polling" = OLD."polling"
+  AND "bucket" = OLD."bucket";
+
+COMMENT ON VIEW "expired_member_contingent_counter" IS 'Rows of table "member_contingent_counter" which are outside the longest time frame of all contingents, and which can be deleted';
+COMMENT ON RULE "delete" ON "expired_member_contingent_counter" IS 'Rule allowing DELETE on rows in "expired_member_contingent_counter" view, i.e. DELETE FROM "expired_member_contingent_counter"';
+
+CREATE OR REPLACE VIEW "garbage_collection_backlog" AS
+  SELECT
+    (SELECT count(1) FROM "expired_session") AS "expired_session_count",
+    (SELECT count(1) FROM "expired_token")   AS "expired_token_count",
+    (SELECT count(1) FROM "unused_snapshot") AS "unused_snapshot_count",
+    (SELECT count(1) FROM "expired_member_contingent_counter")
+      AS "expired_member_contingent_counter_count";
+
+COMMENT ON VIEW "garbage_collection_backlog" IS 'Number of rows which are waiting to be deleted by the garbage collection of "lf_update"; "lf_update" deletes these rows in batches with a limited budget per run, so non-zero values which persist over several runs indicate that the budget is too small';
+
+CREATE OR REPLACE VIEW "member_contingent" AS
+  SELECT
+    "member"."id" AS "member_id",
+    "contingent"."polling",
+    "contingent"."time_frame",
+    CASE WHEN "contingent"."text_entry_limit" NOTNULL THEN (
+      SELECT COALESCE(sum("counter"."text_entry_count"), 0)
+      FROM "member_contingent_counter" AS "counter"
+      WHERE "counter"."member_id" = "member"."id"
+      AND "counter"."polling" = "contingent"."polling"
+      AND "counter"."bucket" > now() - "contingent"."time_frame" - '1 minute'::INTERVAL
+    ) ELSE NULL END AS "text_entry_count",
+    "contingent"."text_entry_limit",
+    CASE WHEN "contingent"."initiative_limit" NOTNULL THEN (
+      SELECT COALESCE(sum("counter"."initiative_count"), 0)
+      FROM "member_contingent_counter" AS "counter"
+      WHERE "counter"."member_id" = "member"."id"
+      AND "counter"."polling" = "contingent"."polling"
+      AND "counter"."bucket" > now() - "contingent"."time_frame" - '1 minute'::INTERVAL
+    ) ELSE NULL END AS "initiative_count",
+    "contingent"."initiative_limit"
+  FROM "member" CROSS JOIN "contingent";
+
+COMMENT ON VIEW "member_contingent" IS 'Actual counts of text entries and initiatives are calculated per member for each limit in the "contingent" table (using the per-minute counters in table "member_contingent_counter", where the oldest minute is counted completely, i.e. the time frame is effectively extended by up to one minute).';
+
+CREATE OR REPLACE FUNCTION "check_everything"()
+  RETURNS VOID
+  LANGUAGE 'plpgsql' VOLATILE AS $$
+    DECLARE
+      "area_id_v"     "area"."id"%TYPE;
+      "snapshot_id_v" "snapshot"."id"%TYPE;
+      "issue_id_v"    "issue"."id"%TYPE;
+      "persist_v"     "check_issue_persistence";
+    BEGIN
+      RAISE WARNING 'Function "check_everything" should only be used for development and debugging purposes';
+      DELETE FROM "expired_session";
+      DELETE FROM "expired_token";
+      DELETE FROM "unused_snapshot";
+      DELETE FROM "expired_member_contingent_counter";
+      PERFORM "check_activity"();
+      PERFORM "calculate_member_counts"();
+      FOR "area_id_v" IN SELECT "id" FROM "area_with_unaccepted_issues" LOOP
+        SELECT "take_snapshot"(NULL, "area_id_v") INTO "snapshot_id_v";
+        PERFORM "finish_snapshot"("issue_id") FROM "snapshot_issue"
+          WHERE "snapshot_id" = "snapshot_id_v";
+        LOOP
+          EXIT WHEN "issue_admission"("area_id_v") = FALSE;
+        END LOOP;
+      END LOOP;
+      FOR "issue_id_v" IN SELECT "id" FROM "open_issue" LOOP
+        "persist_v" := NULL;
+        LOOP
+          "persist_v" := "check_issue"("issue_id_v", "persist_v");
+          EXIT WHEN "persist_v" ISNULL;
+        END LOOP;
+      END LOOP;
+      DELETE FROM "unused_snapshot";
+      DELETE FROM "expired_member_contingent_counter";
+      RETURN;
+    END;
+  $$;
+
+CREATE TABLE "effective_delegation" (
+        "truster_id"            INT4            NOT NULL REFERENCES "member" ("id") ON DELETE CASCADE ON UPDATE CASCADE,
+        "unit_id"               INT4            NOT NULL REFERENCES "unit" ("id") ON DELETE CASCADE ON UPDATE CASCADE,
+        "area_id"               INT4            REFERENCES "area" ("id") ON DELETE CASCADE ON UPDATE CASCADE,
+        "issue_id"              INT4            REFERENCES "issue" ("id") ON DELETE CASCADE ON UPDATE CASCADE,
+        "delegation_id"         INT8            NOT NULL REFERENCES "delegation" ("id") ON DELETE CASCADE ON UPDATE CASCADE,
+        "trustee_id"            INT4,
+        "scope"              "delegation_scope" NOT NULL,
+        CONSTRAINT "area_id_set_if_issue_id_set" CHECK ("issue_id" ISNULL OR "area_id" NOTNULL) );
+CREATE UNIQUE INDEX "effective_delegation_unit_id_truster_id_idx" ON "effective_delegation" ("unit_id", "truster_id") WHERE "area_id" ISNULL;
+CREATE UNIQUE INDEX "effective_delegation_area_id_truster_id_idx" ON "effective_delegation" ("area_id", "truster_id") WHERE "issue_id" ISNULL;
+CREATE UNIQUE INDEX "effective_delegation_issue_id_truster_id_idx" ON "effective_delegation" ("issue_id", "truster_id");
+CREATE INDEX "effective_delegation_issue_id_trustee_id_idx" ON "effective_delegation" ("issue_id", "trustee_id");
+CREATE INDEX "effective_delegation_truster_id_unit_id_idx" ON "effective_delegation" ("truster_id", "unit_id");
+CREATE INDEX "effective_delegation_trustee_id_idx" ON "effective_delegation" ("trustee_id");
+CREATE INDEX "effective_delegation_delegation_id_idx" ON "effective_delegation" ("delegation_id");
+
+COMMENT ON TABLE "effective_delegation" IS 'Outgoing delegation of a member which takes precedence (issue over area over unit) for each unit, area, and open issue; Maintained by triggers on tables "delegation", "area", and "issue", and used by views "unit_delegation", "area_delegation", "issue_delegation", and function "delegation_chain"; Trusters are not filtered by activity or voting right (which is done by the views)';
+
+COMMENT ON COLUMN "effective_delegation"."unit_id"       IS 'Unit of the unit, area, or issue (always set)';
+COMMENT ON COLUMN "effective_delegation"."area_id"       IS 'Area of the area or issue, or NULL for unit-wide rows';
+COMMENT ON COLUMN "effective_delegation"."issue_id"      IS 'Issue, or NULL for unit-wide and area-wide rows; Rows only exist for issues which are not closed';
+COMMENT ON COLUMN "effective_delegation"."delegation_id" IS 'Delegation taking precedence';
+COMMENT ON COLUMN "effective_delegation"."trustee_id"    IS 'Copied from "delegation"."trustee_id"; NULL if delegation has been explicitly disabled for the area or issue';
+COMMENT ON COLUMN "effective_delegation"."scope"         IS 'Copied from "delegation"."scope"';
+
+CREATE FUNCTION "lock_effective_delegation"
+  ( "unit_id_p"             "unit"."id"%TYPE,
+    "truster_id_p"          "member"."id"%TYPE = NULL )
+  RETURNS VOID
+  LANGUAGE 'plpgsql' VOLATILE AS $$
+    BEGIN
+      -- NOTE: 1818649956 is 'lfed' in ASCII; the rows of a single truster
+      --       are locked with the 64 bit key space, which does not
+      --       overlap with the key space of two 32 bit keys
+      IF "truster_id_p" ISNULL THEN
+        PERFORM pg_advisory_xact_lock(1818649956, "unit_id_p");
+      ELSE
+        PERFORM pg_advisory_xact_lock_shared(1818649956, "unit_id_p");
+        PERFORM pg_advisory_xact_lock(
+          ("unit_id_p"::INT8 << 32) | "truster_id_p" );
+      END IF;
+      RETURN;
+    END;
+  $$;
+
+COMMENT ON FUNCTION "lock_effective_delegation"
+  ( "unit"."id"%TYPE,
+    "member"."id"%TYPE )
+  IS 'Serializes the maintenance of "effective_delegation" through transaction-level advisory locks: Recalculation of all rows of a unit, area, or issue requires an exclusive lock on the unit (when no truster is given), while recalculation of the rows of a single truster requires a shared lock on the unit and an exclusive lock on the truster within the unit; Must be called before reading the "delegation" table, such that subsequent statements see the changes of transactions which held a conflicting lock';
+
+
+CREATE FUNCTION "update_effective_delegation"
+  ( "truster_id_p"          "member"."id"%TYPE,
+    "unit_id_p"             "unit"."id"%TYPE )
+  RETURNS VOID
+  LANGUAGE 'plpgsql' VOLATILE AS $$
+    BEGIN
+      PERFORM "lock_effective_delegation"("unit_id_p", "truster_id_p");
+      DELETE FROM "effective_delegation"
+        WHERE "truster_id" = "truster_id_p" AND "unit_id" = "unit_id_p";
+      INSERT INTO "effective_delegation" (
+          "truster_id", "unit_id", "area_id", "issue_id",
+          "delegation_id", "trustee_id", "scope"
+        ) SELECT
+          "truster_id", "unit_id", NULL, NULL,
+          "id", "trustee_id", "scope"
+        FROM "delegation"
+        WHERE "truster_id" = "truster_id_p" AND "unit_id" = "unit_id_p";
+      INSERT INTO "effective_delegation" (
+          "truster_id", "unit_id", "area_id", "issue_id",
+          "delegation_id", "trustee_id", "scope"
+        ) SELECT DISTINCT ON ("area"."id")
+          "truster_id_p", "unit_id_p", "area"."id", NULL,
+          "delegation"."id", "delegation"."trustee_id", "delegation"."scope"
+        FROM "area"
+        JOIN "delegation"
+          ON "delegation"."truster_id" = "truster_id_p"
+          AND (
+            "delegation"."unit_id" = "area"."unit_id" OR
+            "delegation"."area_id" = "area"."id"
+          )
+        WHERE "area"."unit_id" = "unit_id_p"
+        ORDER BY "area"."id", "delegation"."scope" DESC;
+      INSERT INTO "effective_delegation" (
+          "truster_id", "unit_id", "area_id", "issue_id",
+          "delegation_id", "trustee_id", "scope"
+        ) SELECT DISTINCT ON ("issue"."id")
+          "truster_id_p", "unit_id_p", "area"."id", "issue"."id",
+          "delegation"."id", "delegation"."trustee_id", "delegation"."scope"
+        FROM "issue"
+        JOIN "area" ON "area"."id" = "issue"."area_id"
+        JOIN "delegation"
+          ON "delegation"."truster_id" = "truster_id_p"
+          AND (
+            "delegation"."unit_id" = "area"."unit_id" OR
+            "delegation"."area_id" = "area"."id" OR
+            "delegation"."issue_id" = "issue"."id"
+          )
+        WHERE "area"."unit_id" = "unit_id_p"
+        AND "issue"."closed" ISNULL
+        ORDER BY "issue"."id", "delegation"."scope" DESC;
+      RETURN;
+    END;
+  $$;
+
+COMMENT ON FUNCTION "update_effective_delegation"
+  ( "member"."id"%TYPE,
+    "unit"."id"%TYPE )
+  IS 'Recalculates all rows of "effective_delegation" of a given truster within a given unit';
+
+
+CREATE FUNCTION "update_effective_delegation_for_issue"
+  ( "issue_id_p"            "issue"."id"%TYPE )
+  RETURNS VOID
+  LANGUAGE 'plpgsql' VOLATILE AS $$
+    BEGIN
+      PERFORM "lock_effective_delegation"("area"."unit_id")
+        FROM "issue" JOIN "area" ON "area"."id" = "issue"."area_id"
+        WHERE "issue"."id" = "issue_id_p";
+      DELETE FROM "effective_delegation" WHERE "issue_id" = "issue_id_p";
+      INSERT INTO "effective_delegation" (
+          "truster_id", "unit_id", "area_id", "issue_id",
+          "delegation_id", "trustee_id", "scope"
+        ) SELECT DISTINCT ON ("delegation"."truster_id")
+          "delegation"."truster_id", "area"."unit_id", "area"."id", "issue"."id",
+          "delegation"."id", "delegation"."trustee_id", "delegation"."scope"
+        FROM "issue"
+        JOIN "area" ON "area"."id" = "issue"."area_id"
+        JOIN "delegation"
+          ON "delegation"."unit_id" = "area"."unit_id"
+          OR "delegation"."area_id" = "area"."id"
+          OR "delegation"."issue_id" = "issue"."id"
+        WHERE "issue"."id" = "issue_id_p"
+        AND "issue"."closed" ISNULL
+        ORDER BY "delegation"."truster_id", "delegation"."scope" DESC;
+      RETURN;
+    END;
+  $$;
+
+COMMENT ON FUNCTION "update_effective_delegation_for_issue"
+  ( "issue"."id"%TYPE )
+  IS 'Recalculates all rows of "effective_delegation" for a given issue (deleting them if the issue is closed)';
+
+
+CREATE FUNCTION "update_effective_delegation_for_area"
+  ( "area_id_p"             "area"."id"%TYPE )
+  RETURNS VOID
+  LANGUAGE 'plpgsql' VOLATILE AS $$
+    BEGIN
+      PERFORM "lock_effective_delegation"("unit_id")
+        FROM "area" WHERE "id" = "area_id_p";
+      DELETE FROM "effective_delegation"
+        WHERE "area_id" = "area_id_p" AND "issue_id" ISNULL;
+      INSERT INTO "effective_delegation" (
+          "truster_id", "unit_id", "area_id", "issue_id",
+          "delegation_id", "trustee_id", "scope"
+        ) SELECT DISTINCT ON ("delegation"."truster_id")
+          "delegation"."truster_id", "area"."unit_id", "area"."id", NULL,
+          "delegation"."id", "delegation"."trustee_id", "delegation"."scope"
+        FROM "area"
+        JOIN "delegation"
+          ON "delegation"."unit_id" = "area"."unit_id"
+          OR "delegation"."area_id" = "area"."id"
+        WHERE "area"."id" = "area_id_p"
+        ORDER BY "delegation"."truster_id", "delegation"."scope" DESC;
+      PERFORM "update_effective_delegation_for_issue"("id")
+        FROM "issue" WHERE "area_id" = "area_id_p";
+      RETURN;
+    END;
+  $$;
+
+COMMENT ON FUNCTION "update_effective_delegation_for_area"
+  ( "area"."id"%TYPE )
+  IS 'Recalculates all rows of "effective_delegation" for a given area and its issues';
+
+
+CREATE FUNCTION "update_effective_delegation_trigger"()
+  RETURNS TRIGGER
+  LANGUAGE 'plpgsql' VOLATILE AS $$
+    DECLARE
+      "old_unit_id_v" "unit"."id"%TYPE;
+      "new_unit_id_v" "unit"."id"%TYPE;
+    BEGIN
+      IF TG_OP != 'INSERT' THEN
+        "old_unit_id_v" := OLD."unit_id";
+        IF "old_unit_id_v" ISNULL THEN
+          SELECT "unit_id" INTO "old_unit_id_v" FROM "area"
+            WHERE "id" = COALESCE(OLD."area_id", (
+              SELECT "area_id" FROM "issue" WHERE "id" = OLD."issue_id"
+            ));
+        END IF;
+      END IF;
+      IF TG_OP != 'DELETE' THEN
+        "new_unit_id_v" := NEW."unit_id";
+        IF "new_unit_id_v" ISNULL THEN
+          SELECT "unit_id" INTO "new_unit_id_v" FROM "area"
+            WHERE "id" = COALESCE(NEW."area_id", (
+              SELECT "area_id" FROM "issue" WHERE "id" = NEW."issue_id"
+            ));
+        END IF;
+      END IF;
+      -- NOTE: unit is NULL if area or issue is being deleted,
+      --       in which case rows are deleted by cascading
+      IF TG_OP = 'UPDATE' THEN
+        IF
+          OLD."truster_id" = NEW."truster_id" AND
+          "old_unit_id_v" = "new_unit_id_v"
+        THEN
+          "old_unit_id_v" := NULL;
+        END IF;
+      END IF;
+      -- NOTE: if the delegation is moved to a different unit, both units
+      --       are locked in the order of their ids to avoid deadlocks
+      IF "old_unit_id_v" > "new_unit_id_v" THEN
+        PERFORM "lock_effective_delegation"(
+          "new_unit_id_v", NEW."truster_id" );
+      END IF;
+      IF "old_unit_id_v" NOTNULL THEN
+        PERFORM "update_effective_delegation"(
+          OLD."truster_id", "old_unit_id_v" );
+      END IF;
+      IF "new_unit_id_v" NOTNULL THEN
+        PERFORM "update_effective_delegation"(
+          NEW."truster_id", "new_unit_id_v" );
+      END IF;
+      RETURN NULL;
+    END;
+  $$;
+
+CREATE TRIGGER "update_effective_delegation"
+  AFTER INSERT OR UPDATE OR DELETE ON "delegation" FOR EACH ROW EXECUTE PROCEDURE
+  "update_effective_delegation_trigger"();
+
+COMMENT ON FUNCTION "update_effective_delegation_trigger"()      IS 'Implementation of trigger "update_effective_delegation" on table "delegation"';
+COMMENT ON TRIGGER "update_effective_delegation" ON "delegation" IS 'Recalculates rows of table "effective_delegation" of the truster within the unit of the delegation';
+
+
+CREATE FUNCTION "update_effective_delegation_for_area_trigger"()
+  RETURNS TRIGGER
+  LANGUAGE 'plpgsql' VOLATILE AS $$
+    BEGIN
+      IF TG_OP = 'UPDATE' THEN
+        IF OLD."unit_id" = NEW."unit_id" THEN
+          RETURN NULL;
+        END IF;
+        -- NOTE: rows of the previous unit are deleted below, and both
+        --       units are locked in the order of their ids
+        PERFORM "lock_effective_delegation"(LEAST(OLD."unit_id", NEW."unit_id"));
+      END IF;
+      PERFORM "update_effective_delegation_for_area"(NEW."id");
+      RETURN NULL;
+    END;
+  $$;
+
+CREATE TRIGGER "update_effective_delegation"
+  AFTER INSERT OR UPDATE OF "unit_id" ON "area" FOR EACH ROW EXECUTE PROCEDURE
+  "update_effective_delegation_for_area_trigger"();
+
+COMMENT ON FUNCTION "update_effective_delegation_for_area_trigger"() IS 'Implementation of trigger "update_effective_delegation" on table "area"';
+COMMENT ON TRIGGER "update_effective_delegation" ON "area"           IS 'Recalculates rows of table "effective_delegation" when an area is created or moved to a different unit';
+
+
+CREATE FUNCTION "update_effective_delegation_for_issue_trigger"()
+  RETURNS TRIGGER
+  LANGUAGE 'plpgsql' VOLATILE AS $$
+    BEGIN
+      IF TG_OP = 'UPDATE' THEN
+        IF
+          OLD."area_id" = NEW."area_id" AND
+          (OLD."closed" ISNULL) = (NEW."closed" ISNULL)
+        THEN
+          RETURN NULL;
+        END IF;
+      END IF;
+      PERFORM "update_effective_delegation_for_issue"(NEW."id");
+      RETURN NULL;
+    END;
+  $$;
+
+CREATE TRIGGER "update_effective_delegation"
+  AFTER INSERT OR UPDATE OF "area_id", "closed" ON "issue" FOR EACH ROW EXECUTE PROCEDURE
+  "update_effective_delegation_for_issue_trigger"();
+
+COMMENT ON FUNCTION "update_effective_delegation_for_issue_trigger"() IS 'Implementation of trigger "update_effective_delegation" on table "issue"';
+COMMENT ON TRIGGER "update_effective_delegation" ON "issue"           IS 'Recalculates rows of table "effective_delegation" when an issue is created, moved to a different area, or closed';
+
+INSERT INTO "effective_delegation" (
+    "truster_id", "unit_id", "area_id", "issue_id",
+    "delegation_id", "trustee_id", "scope"
+  ) SELECT
+    "truster_id", "unit_id", NULL, NULL,
+    "id", "trustee_id", "scope"
+  FROM "delegation" WHERE "unit_id" NOTNULL;
+
+SELECT "update_effective_delegation_for_area"("id") FROM "area";
+
+CREATE OR REPLACE VIEW "unit_delegation" AS
+  SELECT
+    "effective_delegation"."unit_id",
+    "effective_delegation"."delegation_id" AS "id",
+    "effective_delegation"."truster_id",
+    "effective_delegation"."trustee_id",
+    "effective_delegation"."scope"
+  FROM "effective_delegation"
+  JOIN "member"
+    ON "effective_delegation"."truster_id" = "member"."id"
+  JOIN "privilege"
+    ON "effective_delegation"."unit_id" = "privilege"."unit_id"
+    AND "effective_delegation"."truster_id" = "privilege"."member_id"
+  WHERE "effective_delegation"."area_id" ISNULL
+  AND "member"."active" AND "privilege"."voting_right";
+
+COMMENT ON VIEW "unit_delegation" IS 'Unit delegations where trusters are active and have voting right';
+
+CREATE OR REPLACE VIEW "area_delegation" AS
+  SELECT
+    "effective_delegation"."area_id",
+    "effective_delegation"."delegation_id" AS "id",
+    "effective_delegation"."truster_id",
+    "effective_delegation"."trustee_id",
+    "effective_delegation"."scope"
+  FROM "effective_delegation"
+  JOIN "member"
+    ON "effective_delegation"."truster_id" = "member"."id"
+  JOIN "privilege"
+    ON "effective_delegation"."unit_id" = "privilege"."unit_id"
+    AND "effective_delegation"."truster_id" = "privilege"."member_id"
+  WHERE "effective_delegation"."area_id" NOTNULL
+  AND "effective_delegation"."issue_id" ISNULL
+  AND "member"."active" AND "privilege"."voting_right";
+
+COMMENT ON VIEW "area_delegation" IS 'Area delegations where trusters are active and have voting right';
+
+CREATE OR REPLACE VIEW "issue_delegation" AS
+  SELECT
+    "effective_delegation"."issue_id",
+    "effective_delegation"."delegation_id" AS "id",
+    "effective_delegation"."truster_id",
+    "effective_delegation"."trustee_id",
+    COALESCE("issue_privilege"."weight", "privilege"."weight") AS "weight",
+    "effective_delegation"."scope"
+  FROM "effective_delegation"
+  JOIN "member"
+    ON "effective_delegation"."truster_id" = "member"."id"
+  LEFT JOIN "privilege"
+    ON "effective_delegation"."unit_id" = "privilege"."unit_id"
+    AND "effective_delegation"."truster_id" = "privilege"."member_id"
+  LEFT JOIN "issue_privilege"
+    ON "effective_delegation"."issue_id" = "issue_privilege"."issue_id"
+    AND "effective_delegation"."truster_id" = "issue_privilege"."member_id"
+  WHERE "effective_delegation"."issue_id" NOTNULL
+  AND "member"."active"
+  AND COALESCE("issue_privilege"."voting_right", "privilege"."voting_right");
+
+COMMENT ON VIEW "issue_delegation" IS 'Issue delegations where trusters are active and have voting right (only for issues which are not closed, see table "delegating_voter" for closed issues)';
+
+CREATE OR REPLACE FUNCTION "delegation_chain"
+  ( "member_id_p"           "member"."id"%TYPE,
+    "unit_id_p"             "unit"."id"%TYPE,
+    "area_id_p"             "area"."id"%TYPE,
+    "issue_id_p"            "issue"."id"%TYPE,
+    "simulate_trustee_id_p" "member"."id"%TYPE DEFAULT NULL,
+    "simulate_default_p"    BOOLEAN            DEFAULT FALSE )
+  RETURNS SETOF "delegation_chain_row"
+  LANGUAGE 'plpgsql' STABLE AS $$
+    DECLARE
+      "scope_v"            "delegation_scope";
+      "unit_id_v"          "unit"."id"%TYPE;
+      "area_id_v"          "area"."id"%TYPE;
+      "issue_row"          "issue"%ROWTYPE;
+      "visited_member_ids" INT4[];  -- "member"."id"%TYPE[]
+      "loop_member_id_v"   "member"."id"%TYPE;
+      "output_row"         "delegation_chain_row";
+      "output_rows"        "delegation_chain_row"[];
+      "simulate_v"         BOOLEAN;
+      "simulate_here_v"    BOOLEAN;
+      "delegation_row"     "delegation"%ROWTYPE;
+      "row_count"          INT4;
+      "i"                  INT4;
+      "loop_v"             BOOLEAN;
+    BEGIN
+      IF "simulate_trustee_id_p" NOTNULL AND "simulate_default_p" THEN
+        RAISE EXCEPTION 'Both "simulate_trustee_id_p" is set, and "simulate_default_p" is true';
+      END IF;
+      IF "simulate_trustee_id_p" NOTNULL OR "simulate_default_p" THEN
+        "simulate_v" := TRUE;
+      ELSE
+        "simulate_v" := FALSE;
+      END IF;
+      IF
+        "unit_id_p" NOTNULL AND
+        "area_id_p" ISNULL AND
+        "issue_id_p" ISNULL
+      THEN
+        "scope_v" := 'unit';
+        "unit_id_v" := "unit_id_p";
+      ELSIF
+        "unit_id_p" ISNULL AND
+        "area_id_p" NOTNULL AND
+        "issue_id_p" ISNULL
+      THEN
+        "scope_v" := 'area';
+        "area_id_v" := "area_id_p";
+        SELECT "unit_id" INTO "unit_id_v"
+          FROM "area" WHERE "id" = "area_id_v";
+      ELSIF
+        "unit_id_p" ISNULL AND
+        "area_id_p" ISNULL AND
+        "issue_id_p" NOTNULL
+      THEN
+        SELECT INTO "issue_row" * FROM "issue" WHERE "id" = "issue_id_p";
+        IF "issue_row"."id" ISNULL THEN
+          RETURN;
+        END IF;
+        IF "issue_row"."closed" NOTNULL THEN
+          IF "simulate_v" THEN
+            RAISE EXCEPTION 'Tried to simulate delegation chain for closed issue.';
+          END IF;
+          FOR "output_row" IN
+            SELECT * FROM
+            "delegation_chain_for_closed_issue"("member_id_p", "issue_id_p")
+          LOOP
+            RETURN NEXT "output_row";
+          END LOOP;
+          RETURN;
+        END IF;
+        "scope_v" := 'issue';
+        SELECT "area_id" INTO "area_id_v"
+          FROM "issue" WHERE "id" = "issue_id_p";
+        SELECT "unit_id" INTO "unit_id_v"
+          FROM "area"  WHERE "id" = "area_id_v";
+      ELSE
+        RAISE EXCEPTION 'Exactly one of unit_id_p, area_id_p, or issue_id_p must be NOTNULL.';
+      END IF;
+      "visited_member_ids" := '{}';
+      "loop_member_id_v"   := NULL;
+      "output_rows"        := '{}';
+      "output_row"."index"         := 0;
+      "output_row"."member_id"     := "member_id_p";
+      "output_row"."member_valid"  := TRUE;
+      "output_row"."participation" := FALSE;
+      "output_row"."overridden"    := FALSE;
+      "output_row"."disabled_out"  := FALSE;
+      "output_row"."scope_out"     := NULL;
+      LOOP
+        IF "visited_member_ids" @> ARRAY["output_row"."member_id"] THEN
+          "loop_member_id_v" := "output_row"."member_id";
+        ELSE
+          "visited_member_ids" :=
+            "visited_member_ids" || "output_row"."member_id";
+        END IF;
+        IF "output_row"."participation" ISNULL THEN
+          "output_row"."overridden" := NULL;
+        ELSIF "output_row"."participation" THEN
+          "output_row"."overridden" := TRUE;
+        END IF;
+        "output_row"."scope_in" := "output_row"."scope_out";
+        "output_row"."member_valid" := EXISTS (
+          SELECT NULL FROM "member"
+          LEFT JOIN "privilege"
+          ON "privilege"."member_id" = "member"."id"
+          AND "privilege"."unit_id" = "unit_id_v"
+          LEFT JOIN "issue_privilege"
+          ON "issue_privilege"."member_id" = "member"."id"
+          AND "issue_privilege"."issue_id" = "issue_id_p"
+          WHERE "id" = "output_row"."member_id"
+          AND "member"."active"
+          AND COALESCE(
+            "issue_privilege"."voting_right", "privilege"."voting_right")
+        );
+        "simulate_here_v" := (
+          "simulate_v" AND
+          "output_row"."member_id" = "member_id_p"
+        );
+        "delegation_row" := ROW(NULL);
+        IF "output_row"."member_valid" OR "simulate_here_v" THEN
+          IF "scope_v" = 'unit' THEN
+            IF NOT "simulate_here_v" THEN
+              SELECT * INTO "delegation_row" FROM "delegation"
+                WHERE "truster_id" = "output_row"."member_id"
+                AND "unit_id" = "unit_id_v";
+            END IF;
+          ELSIF "scope_v" = 'area' THEN
+            IF "simulate_here_v" THEN
+              IF "simulate_trustee_id_p" ISNULL THEN
+                SELECT * INTO "delegation_row" FROM "delegation"
+                  WHERE "truster_id" = "output_row"."member_id"
+                  AND "unit_id" = "unit_id_v";
+              END IF;
+            ELSE
+              SELECT "delegation".* INTO "delegation_row"
+                FROM "effective_delegation" JOIN "delegation"
+                ON "delegation"."id" = "effective_delegation"."delegation_id"
+                WHERE "effective_delegation"."truster_id" = "output_row"."member_id"
+                AND "effective_delegation"."area_id" = "area_id_v"
+                AND "effective_delegation"."issue_id" ISNULL;
+            END IF;
+          ELSIF "scope_v" = 'issue' THEN
+            IF "issue_row"."fully_frozen" ISNULL THEN
+              "output_row"."participation" := EXISTS (
+                SELECT NULL FROM "interest"
+                WHERE "issue_id" = "issue_id_p"
+                AND "member_id" = "output_row"."member_id"
+              );
+            ELSE
+              IF "output_row"."member_id" = "member_id_p" THEN
+                "output_row"."participation" := EXISTS (
+                  SELECT NULL FROM "direct_voter"
+                  WHERE "issue_id" = "issue_id_p"
+                  AND "member_id" = "output_row"."member_id"
+                );
+              ELSE
+                "output_row"."participation" := NULL;
+              END IF;
+            END IF;
+            IF "simulate_here_v" THEN
+              IF "simulate_trustee_id_p" ISNULL THEN
+                SELECT "delegation".* INTO "delegation_row"
+                  FROM "effective_delegation" JOIN "delegation"
+                  ON "delegation"."id" = "effective_delegation"."delegation_id"
+                  WHERE "effective_delegation"."truster_id" = "output_row"."member_id"
+                  AND "effective_delegation"."area_id" = "area_id_v"
+                  AND "effective_delegation"."issue_id" ISNULL;
+              END IF;
+            ELSE
+              SELECT "delegation".* INTO "delegation_row"
+                FROM "effective_delegation" JOIN "delegation"
+                ON "delegation"."id" = "effective_delegation"."delegation_id"
+                WHERE "effective_delegation"."truster_id" = "output_row"."member_id"
+                AND "effective_delegation"."issue_id" = "issue_id_p";
+            END IF;
+          END IF;
+        ELSE
+          "output_row"."participation" := FALSE;
+        END IF;
+        IF "simulate_here_v" AND "simulate_trustee_id_p" NOTNULL THEN
+          "output_row"."scope_out" := "scope_v";
+          "output_rows" := "output_rows" || "output_row";
+          "output_row"."member_id" := "simulate_trustee_id_p";
+        ELSIF "delegation_row"."trustee_id" NOTNULL THEN
+          "output_row"."scope_out" := "delegation_row"."scope";
+          "output_rows" := "output_rows" || "output_row";
+          "output_row"."member_id" := "delegation_row"."trustee_id";
+        ELSIF "delegation_row"."scope" NOTNULL THEN
+          "output_row"."scope_out" := "delegation_row"."scope";
+          "output_row"."disabled_out" := TRUE;
+          "output_rows" := "output_rows" || "output_row";
+          EXIT;
+        ELSE
+          "output_row"."scope_out" := NULL;
+          "output_rows" := "output_rows" || "output_row";
+          EXIT;
+        END IF;
+        EXIT WHEN "loop_member_id_v" NOTNULL;
+        "output_row"."index" := "output_row"."index" + 1;
+      END LOOP;
+      "row_count" := array_upper("output_rows", 1);
+      "i"      := 1;
+      "loop_v" := FALSE;
+      LOOP
+        "output_row" := "output_rows"["i"];
+        EXIT WHEN "output_row" ISNULL;  -- NOTE: ISNULL and NOT ... NOTNULL produce different results!
+        IF "loop_v" THEN
+          IF "i" + 1 = "row_count" THEN
+            "output_row"."loop" := 'last';
+          ELSIF "i" = "row_count" THEN
+            "output_row"."loop" := 'repetition';
+          ELSE
+            "output_row"."loop" := 'intermediate';
+          END IF;
+        ELSIF "output_row"."member_id" = "loop_member_id_v" THEN
+          "output_row"."loop" := 'first';
+          "loop_v" := TRUE;
+        END IF;
+        IF "scope_v" = 'unit' THEN
+          "output_row"."participation" := NULL;
+        END IF;
+        RETURN NEXT "output_row";
+        "i" := "i" + 1;
+      END LOOP;
+      RETURN;
+    END;
+  $$;
+
+CREATE FUNCTION "private_data_filter"
+  ( "table_p"               REGCLASS,
+    "visited_tables_p"      REGCLASS[] DEFAULT '{}' )
+  RETURNS TEXT
+  LANGUAGE 'plpgsql' STABLE AS $$
+    DECLARE
+      "conditions_v"   TEXT[];
+      "constraint_row" RECORD;
+      "filter_v"       TEXT;
+      "null_check_v"   TEXT;
+      "join_v"         TEXT;
+    BEGIN
+      IF "table_p" IN (
+        'temporary_transaction_data'::REGCLASS,
+        'temporary_suggestion_counts'::REGCLASS,
+        'verification'::REGCLASS,
+        'member_settings'::REGCLASS,
+        'member_useterms'::REGCLASS,
+        'member_profile'::REGCLASS,
+        'rendered_member_statement'::REGCLASS,
+        'member_image'::REGCLASS,
+        'contact'::REGCLASS,
+        'ignored_member'::REGCLASS,
+        'session'::REGCLASS,
+        'system_application'::REGCLASS,
+        'system_application_redirect_uri'::REGCLASS,
+        'dynamic_application_scope'::REGCLASS,
+        'member_application'::REGCLASS,
+        'token'::REGCLASS,
+        'subscription'::REGCLASS,
+        'ignored_area'::REGCLASS,
+        'ignored_initiative'::REGCLASS,
+        'non_voter'::REGCLASS,
+        'event_processed'::REGCLASS,
+        'notification_initiative_sent'::REGCLASS,
+        'newsletter'::REGCLASS,
+        'data_change'::REGCLASS )
+      THEN
+        RETURN 'FALSE';
+      END IF;
+      "conditions_v" := '{}';
+      IF "table_p" = 'member'::REGCLASS THEN
+        "conditions_v" := "conditions_v" ||
+          '"member"."activated" NOTNULL'::TEXT;
+      ELSIF "table_p" = 'direct_voter'::REGCLASS THEN
+        "conditions_v" := "conditions_v" ||
+          'EXISTS (SELECT NULL FROM "issue" WHERE "issue"."id" = "direct_voter"."issue_id" AND "issue"."closed" NOTNULL)'::TEXT;
+      END IF;
+      -- rows referencing filtered rows are filtered as well
+      -- (like rows which would be deleted by ON DELETE CASCADE):
+      FOR "constraint_row" IN
+        SELECT "conname", "confrelid"::REGCLASS AS "referenced_table",
+          "conkey", "confkey", "confdeltype"
+        FROM "pg_constraint"
+        WHERE "conrelid" = "table_p" AND "contype" = 'f'
+        AND "confrelid"::REGCLASS != "table_p"
+        AND NOT "confrelid"::REGCLASS = ANY ("visited_tables_p")
+        ORDER BY "conname"
+      LOOP
+        "filter_v" := "private_data_filter"(
+          "constraint_row"."referenced_table",
+          "visited_tables_p" || "table_p" );
+        CONTINUE WHEN "filter_v" ISNULL;
+        IF "constraint_row"."confdeltype" IN ('n', 'd') THEN
+          RAISE EXCEPTION 'Foreign key "%" of table % references filtered table % with ON DELETE SET NULL or SET DEFAULT', "constraint_row"."conname", "table_p", "constraint_row"."referenced_table";
+        END IF;
+        CONTINUE WHEN "constraint_row"."confdeltype" != 'c';
+        SELECT
+          string_agg(format('%s.%I ISNULL', "table_p", "a"."attname"), ' OR '),
+          string_agg(format('%s.%I = %s.%I', "constraint_row"."referenced_table", "b"."attname", "table_p", "a"."attname"), ' AND ')
+          INTO "null_check_v", "join_v"
+          FROM unnest("constraint_row"."conkey", "constraint_row"."confkey")
+            AS "key" ("attnum", "referenced_attnum")
+          JOIN "pg_attribute" AS "a"
+            ON "a"."attrelid" = "table_p"
+            AND "a"."attnum" = "key"."attnum"
+          JOIN "pg_attribute" AS "b"
+            ON "b"."attrelid" = "constraint_row"."referenced_table"
+            AND "b"."attnum" = "key"."referenced_attnum";
+        "conditions_v" := "conditions_v" || format(
+          '(%s OR EXISTS (SELECT NULL FROM %s WHERE %s AND (%s)))',
+          "null_check_v", "constraint_row"."referenced_table",
+          "join_v", "filter_v" );
+      END LOOP;
+      IF "conditions_v" = '{}' THEN
+        RETURN NULL;
+      END IF;
+      RETURN array_to_string("conditions_v", ' AND ');
+    END;
+  $$;
+
+COMMENT ON FUNCTION "private_data_filter"(REGCLASS, REGCLASS[]) IS 'Returns a condition (as SQL text, referring to the table by its name) which is true for all rows of the given table that are publicly available, ''FALSE'' if no row is publicly available, or NULL if all rows are publicly available; Rows referencing filtered rows through a foreign key with ON DELETE CASCADE are filtered too; Used by function "private_data_export_query" and must be kept consistent with function "delete_private_data"';
+
+
+CREATE FUNCTION "private_data_export_query"("table_p" REGCLASS)
+  RETURNS TEXT
+  LANGUAGE 'plpgsql' STABLE AS $$
+    DECLARE
+      "filter_v" TEXT;
+      "query_v"  TEXT;
+    BEGIN
+      "filter_v" := "private_data_filter"("table_p");
+      IF "filter_v" = 'FALSE' THEN
+        RETURN NULL;
+      END IF;
+      IF "table_p" = 'member'::REGCLASS THEN
+        "query_v" := format(
+          'SELECT "anonymized".* FROM %s, jsonb_populate_record(%s, %L::JSONB) AS "anonymized"',
+          "table_p", "table_p", jsonb_build_object(
+            'invite_code',                  NULL,
+            'invite_code_expiry',           NULL,
+            'admin_comment',                NULL,
+            'last_login',                   NULL,
+            'last_delegation_check',        NULL,
+            'login',                        NULL,
+            'password',                     NULL,
+            'authority',                    NULL,
+            'authority_uid',                NULL,
+            'authority_login',              NULL,
+            'lang',                         NULL,
+            'notify_email',                 NULL,
+            'notify_email_unconfirmed',     NULL,
+            'notify_email_secret',          NULL,
+            'notify_email_secret_expiry',   NULL,
+            'notify_email_lock_expiry',     NULL,
+            'disable_notifications',        TRUE,
+            'notification_counter',         1,
+            'notification_sample_size',     0,
+            'notification_dow',             NULL,
+            'notification_hour',            NULL,
+            'notification_sent',            NULL,
+            'login_recovery_expiry',        NULL,
+            'password_reset_secret',        NULL,
+            'password_reset_secret_expiry', NULL,
+            'location',                     NULL ) );
+      ELSE
+        "query_v" := format('SELECT * FROM %s', "table_p");
+      END IF;
+      IF "filter_v" NOTNULL THEN
+        "query_v" := "query_v" || ' WHERE ' || "filter_v";
+      END IF;
+      RETURN "query_v";
+    END;
+  $$;
+
+COMMENT ON FUNCTION "private_data_export_query"(REGCLASS) IS 'Returns a query (as SQL text) selecting all publicly available data of the given table, or NULL if no data of the table is publicly available; Used by lf_export script to export data without copying the database; Applies the same rules as function "delete_private_data" (see function "private_data_filter")';
+
+COMMENT ON FUNCTION "delete_private_data"() IS 'DO NOT USE on productive database, but only on a copy! This function deletes all data which should not be publicly available, and can be used to create a database dump for publication. See source code to see which data is deleted. The lf_export script does not use this function but applies the same rules while reading (see functions "private_data_filter" and "private_data_export_query"), which must be kept consistent with this function. If you need a different behaviour, modify these functions accordingly, to avoid data-leaks after updating.';
+
+ALTER TABLE "system_setting" ADD COLUMN "data_change_ttl" INTERVAL;
+COMMENT ON COLUMN "system_setting"."data_change_ttl"    IS 'Time after entries in table "data_change" are deleted; Must be longer than the interval between incremental exports; If NULL, changes are not logged and incremental exports are not possible.';
+
+CREATE TABLE "data_change" (
+        "id"                    SERIAL8         PRIMARY KEY,
+        "xid"                   INT8            NOT NULL DEFAULT txid_current(),
+        "logged"                TIMESTAMPTZ     NOT NULL DEFAULT now(),
+        "table_name"            TEXT            NOT NULL,
+        "key"                   JSONB           NOT NULL );
+CREATE UNIQUE INDEX "data_change_xid_table_name_key_idx" ON "data_change" ("xid", "table_name", "key");
+CREATE INDEX "data_change_logged_idx" ON "data_change" ("logged");
+
+COMMENT ON TABLE "data_change" IS 'Log of changed rows, written by triggers "log_data_change", "log_data_change_on_update", and "log_data_change_on_delete" on all tables with publicly available data if "system_setting"."data_change_ttl" is set, and used by lf_export to create incremental exports; Entries older than "system_setting"."data_change_ttl" are deleted by "lf_update" (see view "expired_data_change")';
+
+COMMENT ON COLUMN "data_change"."xid"        IS 'Transaction ID of the change (used to determine which changes are visible in a snapshot of a previous export)';
+COMMENT ON COLUMN "data_change"."table_name" IS 'Name of the changed table (of the partitioned table for changes of partitions)';
+COMMENT ON COLUMN "data_change"."key"        IS 'JSON object containing the values of the key columns (as passed to the trigger) of the changed row(s), i.e. the primary key or a group of rows which is exported as a whole (e.g. all rows of a snapshot); Logged at most once per transaction';
+
+CREATE FUNCTION "log_data_change_trigger"()
+  RETURNS TRIGGER
+  LANGUAGE 'plpgsql' VOLATILE AS $$
+    DECLARE
+      "key_v" TEXT;  -- expression for the key of a row "row"
+    BEGIN
+      IF NOT EXISTS (
+        SELECT NULL FROM "system_setting" WHERE "data_change_ttl" NOTNULL
+      ) THEN
+        RETURN NULL;
+      END IF;
+      SELECT COALESCE(
+          'jsonb_build_object(' ||
+          string_agg(format('%L, "row".%I', "column", "column"), ', ') || ')',
+          '''{}''::JSONB' )
+        INTO "key_v" FROM unnest(TG_ARGV) AS "column";
+      -- NOTE: as the triggers on table "event" are statement-level triggers
+      --       on the partitioned table (and not on its partitions), changes of
+      --       partitions are logged for the partitioned table, such that
+      --       partitions may be dropped before the log entries expire (see
+      --       lf_archive_events); keys which have already been logged by the
+      --       same transaction are skipped (see unique index
+      --       "data_change_xid_table_name_key_idx"):
+      EXECUTE format(
+        'INSERT INTO "data_change" ("table_name", "key") ' ||
+        'SELECT %L, %s FROM %s AS "row" ON CONFLICT DO NOTHING',
+        TG_TABLE_NAME, "key_v",
+        CASE TG_OP
+          WHEN 'INSERT' THEN '"new_rows"'
+          WHEN 'DELETE' THEN '"old_rows"'
+          ELSE '(SELECT * FROM "old_rows" UNION ALL SELECT * FROM "new_rows")'
+        END );
+      RETURN NULL;
+    END;
+  $$;
+
+COMMENT ON FUNCTION "log_data_change_trigger"() IS 'Implementation of statement-level triggers "log_data_change", "log_data_change_on_update", and "log_data_change_on_delete" with transition tables "new_rows" and "old_rows"; Trigger arguments are the names of the key columns of the table (only "snapshot_id" for tables filled by function "take_snapshot", such that a snapshot is logged once instead of once per row)';
+
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "system_setting"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"();
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "system_setting"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"();
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "system_setting"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"();
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "contingent"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('polling', 'time_frame');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "contingent"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('polling', 'time_frame');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "contingent"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('polling', 'time_frame');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "file"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "file"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "file"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "member"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "member"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "member"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "member_history"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "member_history"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "member_history"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "agent"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('controlled_id', 'controller_id');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "agent"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('controlled_id', 'controller_id');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "agent"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('controlled_id', 'controller_id');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "role_verification"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "role_verification"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "role_verification"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "member_count"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"();
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "member_count"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"();
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "member_count"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"();
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "policy"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "policy"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "policy"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "unit"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "unit"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "unit"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "area"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "area"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "area"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "allowed_policy"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('area_id', 'policy_id');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "allowed_policy"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('area_id', 'policy_id');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "allowed_policy"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('area_id', 'policy_id');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "snapshot"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "snapshot"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "snapshot"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "snapshot_population"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('snapshot_id');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "snapshot_population"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('snapshot_id');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "snapshot_population"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('snapshot_id');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "issue"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "issue"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "issue"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "issue_order_in_admission_state"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "issue_order_in_admission_state"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "issue_order_in_admission_state"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "initiative"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "initiative"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "initiative"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "battle"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('issue_id');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "battle"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('issue_id');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "battle"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('issue_id');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "draft"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "draft"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "draft"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "rendered_draft"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('draft_id', 'format');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "rendered_draft"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('draft_id', 'format');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "rendered_draft"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('draft_id', 'format');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "draft_attachment"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "draft_attachment"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "draft_attachment"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "suggestion"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "suggestion"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "suggestion"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "rendered_suggestion"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('suggestion_id', 'format');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "rendered_suggestion"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('suggestion_id', 'format');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "rendered_suggestion"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('suggestion_id', 'format');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "member_contingent_counter"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('member_id', 'polling', 'bucket');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "member_contingent_counter"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('member_id', 'polling', 'bucket');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "member_contingent_counter"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('member_id', 'polling', 'bucket');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "privilege"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('unit_id', 'member_id');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "privilege"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('unit_id', 'member_id');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "privilege"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('unit_id', 'member_id');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "issue_privilege"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('issue_id', 'member_id');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "issue_privilege"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('issue_id', 'member_id');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "issue_privilege"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('issue_id', 'member_id');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "interest"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('issue_id', 'member_id');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "interest"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('issue_id', 'member_id');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "interest"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('issue_id', 'member_id');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "initiator"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('initiative_id', 'member_id');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "initiator"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('initiative_id', 'member_id');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "initiator"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('initiative_id', 'member_id');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "supporter"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('initiative_id', 'member_id');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "supporter"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('initiative_id', 'member_id');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "supporter"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('initiative_id', 'member_id');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "opinion"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('suggestion_id', 'member_id');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "opinion"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('suggestion_id', 'member_id');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "opinion"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('suggestion_id', 'member_id');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "delegation"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "delegation"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "delegation"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "effective_delegation"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('truster_id', 'unit_id');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "effective_delegation"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('truster_id', 'unit_id');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "effective_delegation"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('truster_id', 'unit_id');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "snapshot_issue"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('snapshot_id');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "snapshot_issue"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('snapshot_id');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "snapshot_issue"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('snapshot_id');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "direct_interest_snapshot"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('snapshot_id');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "direct_interest_snapshot"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('snapshot_id');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "direct_interest_snapshot"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('snapshot_id');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "delegating_interest_snapshot"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('snapshot_id');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "delegating_interest_snapshot"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('snapshot_id');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "delegating_interest_snapshot"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('snapshot_id');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "direct_supporter_snapshot"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('snapshot_id');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "direct_supporter_snapshot"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('snapshot_id');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "direct_supporter_snapshot"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('snapshot_id');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "direct_voter"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('issue_id', 'member_id');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "direct_voter"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('issue_id', 'member_id');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "direct_voter"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('issue_id', 'member_id');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "rendered_voter_comment"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('issue_id', 'member_id', 'format');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "rendered_voter_comment"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('issue_id', 'member_id', 'format');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "rendered_voter_comment"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('issue_id', 'member_id', 'format');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "delegating_voter"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('issue_id', 'member_id');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "delegating_voter"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('issue_id', 'member_id');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "delegating_voter"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('issue_id', 'member_id');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "vote"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('initiative_id', 'member_id');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "vote"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('initiative_id', 'member_id');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "vote"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('initiative_id', 'member_id');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "posting"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "posting"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "posting"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "posting_lexeme"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('posting_id', 'lexeme');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "posting_lexeme"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('posting_id', 'lexeme');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "posting_lexeme"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('posting_id', 'lexeme');
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "event"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "event"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "event"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+COMMENT ON TRIGGER "log_data_change"           ON "system_setting"                 IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "system_setting"                 IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "system_setting"                 IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "contingent"                     IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "contingent"                     IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "contingent"                     IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "file"                           IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "file"                           IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "file"                           IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "member"                         IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "member"                         IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "member"                         IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "member_history"                 IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "member_history"                 IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "member_history"                 IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "agent"                          IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "agent"                          IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "agent"                          IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "role_verification"              IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "role_verification"              IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "role_verification"              IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "member_count"                   IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "member_count"                   IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "member_count"                   IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "policy"                         IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "policy"                         IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "policy"                         IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "unit"                           IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "unit"                           IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "unit"                           IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "area"                           IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "area"                           IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "area"                           IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "allowed_policy"                 IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "allowed_policy"                 IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "allowed_policy"                 IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "snapshot"                       IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "snapshot"                       IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "snapshot"                       IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "snapshot_population"            IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "snapshot_population"            IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "snapshot_population"            IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "issue"                          IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "issue"                          IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "issue"                          IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "issue_order_in_admission_state" IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "issue_order_in_admission_state" IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "issue_order_in_admission_state" IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "initiative"                     IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "initiative"                     IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "initiative"                     IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "battle"                         IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "battle"                         IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "battle"                         IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "draft"                          IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "draft"                          IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "draft"                          IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "rendered_draft"                 IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "rendered_draft"                 IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "rendered_draft"                 IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "draft_attachment"               IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "draft_attachment"               IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "draft_attachment"               IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "suggestion"                     IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "suggestion"                     IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "suggestion"                     IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "rendered_suggestion"            IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "rendered_suggestion"            IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "rendered_suggestion"            IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "member_contingent_counter"      IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "member_contingent_counter"      IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "member_contingent_counter"      IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "privilege"                      IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "privilege"                      IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "privilege"                      IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "issue_privilege"                IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "issue_privilege"                IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "issue_privilege"                IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "interest"                       IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "interest"                       IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "interest"                       IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "initiator"                      IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "initiator"                      IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "initiator"                      IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "supporter"                      IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "supporter"                      IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "supporter"                      IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "opinion"                        IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "opinion"                        IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "opinion"                        IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "delegation"                     IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "delegation"                     IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "delegation"                     IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "effective_delegation"           IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "effective_delegation"           IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "effective_delegation"           IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "snapshot_issue"                 IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "snapshot_issue"                 IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "snapshot_issue"                 IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "direct_interest_snapshot"       IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "direct_interest_snapshot"       IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "direct_interest_snapshot"       IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "delegating_interest_snapshot"   IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "delegating_interest_snapshot"   IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "delegating_interest_snapshot"   IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "direct_supporter_snapshot"      IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "direct_supporter_snapshot"      IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "direct_supporter_snapshot"      IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "direct_voter"                   IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "direct_voter"                   IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "direct_voter"                   IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "rendered_voter_comment"         IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "rendered_voter_comment"         IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "rendered_voter_comment"         IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "delegating_voter"               IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "delegating_voter"               IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "delegating_voter"               IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "vote"                           IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "vote"                           IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "vote"                           IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "posting"                        IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "posting"                        IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "posting"                        IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "posting_lexeme"                 IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "posting_lexeme"                 IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "posting_lexeme"                 IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change"           ON "event"                          IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "event"                          IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "event"                          IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+
+CREATE VIEW "expired_data_change" AS
+  SELECT * FROM "data_change"
+  WHERE "logged" < now() - COALESCE(
+    (SELECT "data_change_ttl" FROM "system_setting"), '0'::INTERVAL );
+
+CREATE RULE "delete" AS ON DELETE TO "expired_data_change" DO INSTEAD
+  DELETE FROM "data_change" WHERE "id" = OLD."id";
+
+COMMENT ON VIEW "expired_data_change" IS 'Entries of table "data_change" which are older than "system_setting"."data_change_ttl" (or all entries if logging is disabled), and which can be deleted';
+COMMENT ON RULE "delete" ON "expired_data_change" IS 'Rule allowing DELETE on rows in "expired_data_change" view, i.e. DELETE FROM "expired_data_change"';
+
+CREATE OR REPLACE VIEW "garbage_collection_backlog" AS
+  SELECT
+    (SELECT count(1) FROM "expired_session") AS "expired_session_count",
+    (SELECT count(1) FROM "expired_token")   AS "expired_token_count",
+    (SELECT count(1) FROM "unused_snapshot") AS "unused_snapshot_count",
+    (SELECT count(1) FROM "expired_member_contingent_counter")
+      AS "expired_member_contingent_counter_count",
+    (SELECT count(1) FROM "expired_data_change") AS "expired_data_change_count";
+
+COMMENT ON VIEW "garbage_collection_backlog" IS 'Number of rows which are waiting to be deleted by the garbage collection of "lf_update"; "lf_update" deletes these rows in batches with a limited budget per run, so non-zero values which persist over several runs indicate that the budget is too small';
+
+CREATE OR REPLACE FUNCTION "check_everything"()
+  RETURNS VOID
+  LANGUAGE 'plpgsql' VOLATILE AS $$
+    DECLARE
+      "area_id_v"     "area"."id"%TYPE;
+      "snapshot_id_v" "snapshot"."id"%TYPE;
+      "issue_id_v"    "issue"."id"%TYPE;
+      "persist_v"     "check_issue_persistence";
+    BEGIN
+      RAISE WARNING 'Function "check_everything" should only be used for development and debugging purposes';
+      DELETE FROM "expired_session";
+      DELETE FROM "expired_token";
+      DELETE FROM "unused_snapshot";
+      DELETE FROM "expired_member_contingent_counter";
+      DELETE FROM "expired_data_change";
+      PERFORM "create_event_partitions"();
+      PERFORM "check_activity"();
+      PERFORM "calculate_member_counts"();
+      FOR "area_id_v" IN SELECT "id" FROM "area_with_unaccepted_issues" LOOP
+        SELECT "take_snapshot"(NULL, "area_id_v") INTO "snapshot_id_v";
+        PERFORM "finish_snapshot"("issue_id") FROM "snapshot_issue"
+          WHERE "snapshot_id" = "snapshot_id_v";
+        LOOP
+          EXIT WHEN "issue_admission"("area_id_v") = FALSE;
+        END LOOP;
+      END LOOP;
+      FOR "issue_id_v" IN SELECT "id" FROM "open_issue" LOOP
+        "persist_v" := NULL;
+        LOOP
+          "persist_v" := "check_issue"("issue_id_v", "persist_v");
+          EXIT WHEN "persist_v" ISNULL;
+        END LOOP;
+      END LOOP;
+      DELETE FROM "unused_snapshot";
+      DELETE FROM "expired_member_contingent_counter";
+      RETURN;
+    END;
+  $$;
+
+CREATE FUNCTION "private_data_delta_export_script"
+  ( "snapshot_p"            TXID_SNAPSHOT )
+  RETURNS SETOF TEXT
+  LANGUAGE 'plpgsql' STABLE AS $$
+    DECLARE
+      "change_row"  RECORD;
+      "table_v"     REGCLASS;
+      "name_v"      TEXT;
+      "condition_v" TEXT;
+      "query_v"     TEXT;
+    BEGIN
+      PERFORM "require_transaction_isolation"();
+      IF NOT EXISTS (
+        SELECT NULL FROM "system_setting" WHERE "data_change_ttl" NOTNULL
+      ) THEN
+        RAISE EXCEPTION 'Logging of data changes is disabled (see "system_setting"."data_change_ttl").';
+      END IF;
+      FOR "change_row" IN
+        SELECT "table_name", jsonb_agg(DISTINCT "key") AS "keys"
+        FROM "data_change"
+        WHERE "xid" >= txid_snapshot_xmin("snapshot_p")
+        AND NOT txid_visible_in_snapshot("xid", "snapshot_p")
+        GROUP BY "table_name"
+        ORDER BY "table_name"
+      LOOP
+        "table_v" := format('%I', "change_row"."table_name")::REGCLASS;
+        SELECT format('%I.%I', "pg_namespace"."nspname", "pg_class"."relname")
+          INTO "name_v"
+          FROM "pg_class"
+          JOIN "pg_namespace" ON "pg_namespace"."oid" = "pg_class"."relnamespace"
+          WHERE "pg_class"."oid" = "table_v";
+        SELECT COALESCE(
+            string_agg(format('"row".%I IS NOT DISTINCT FROM "key".%I', "column", "column"), ' AND '),
+            'TRUE' )
+          INTO "condition_v"
+          FROM jsonb_object_keys("change_row"."keys" -> 0) AS "column";
+        "condition_v" := format(
+          'EXISTS (SELECT NULL FROM jsonb_populate_recordset(NULL::%s, %L) AS "key" WHERE %s)',
+          "name_v", "change_row"."keys", "condition_v" );
+        RETURN NEXT format('SELECT %L;', format(
+          'DELETE FROM %s AS "row" WHERE %s;', "name_v", "condition_v" ));
+        "query_v" := "private_data_export_query"("table_v");
+        IF "query_v" NOTNULL THEN
+          RETURN NEXT format('SELECT %L;', format('COPY %s FROM stdin;', "name_v"));
+          RETURN NEXT format(
+            'COPY (SELECT * FROM (%s) AS "row" WHERE %s) TO STDOUT;',
+            "query_v", "condition_v" );
+          RETURN NEXT 'SELECT ''\.'';';
+        END IF;
+      END LOOP;
+      RETURN;
+    END;
+  $$;
+
+COMMENT ON FUNCTION "private_data_delta_export_script"(TXID_SNAPSHOT) IS 'Returns a psql script (one command per row) which, when executed with unaligned output without headers in the same transaction snapshot, writes an SQL script to stdout that applies all changes of publicly available data since the given snapshot (i.e. deletes all changed rows and inserts their current version, see table "data_change"); Used by lf_export script for incremental exports';
+
+CREATE OR REPLACE FUNCTION "delete_private_data"()
+  RETURNS VOID
+  LANGUAGE 'plpgsql' VOLATILE AS $$
+    BEGIN
+      DELETE FROM "temporary_transaction_data";
+      DELETE FROM "temporary_suggestion_counts";
+      DELETE FROM "member" WHERE "activated" ISNULL;
+      UPDATE "member" SET
+        "invite_code"                  = NULL,
+        "invite_code_expiry"           = NULL,
+        "admin_comment"                = NULL,
+        "last_login"                   = NULL,
+        "last_delegation_check"        = NULL,
+        "login"                        = NULL,
+        "password"                     = NULL,
+        "authority"                    = NULL,
+        "authority_uid"                = NULL,
+        "authority_login"              = NULL,
+        "lang"                         = NULL,
+        "notify_email"                 = NULL,
+        "notify_email_unconfirmed"     = NULL,
+        "notify_email_secret"          = NULL,
+        "notify_email_secret_expiry"   = NULL,
+        "notify_email_lock_expiry"     = NULL,
+        "disable_notifications"        = TRUE,
+        "notification_counter"         = DEFAULT,
+        "notification_sample_size"     = 0,
+        "notification_dow"             = NULL,
+        "notification_hour"            = NULL,
+        "notification_sent"            = NULL,
+        "login_recovery_expiry"        = NULL,
+        "password_reset_secret"        = NULL,
+        "password_reset_secret_expiry" = NULL,
+        "location"                     = NULL;
+      DELETE FROM "verification";
+      DELETE FROM "member_settings";
+      DELETE FROM "member_useterms";
+      DELETE FROM "member_profile";
+      DELETE FROM "rendered_member_statement";
+      DELETE FROM "member_image";
+      DELETE FROM "contact";
+      DELETE FROM "ignored_member";
+      DELETE FROM "session";
+      DELETE FROM "system_application";
+      DELETE FROM "system_application_redirect_uri";
+      DELETE FROM "dynamic_application_scope";
+      DELETE FROM "member_application";
+      DELETE FROM "token";
+      DELETE FROM "subscription";
+      DELETE FROM "ignored_area";
+      DELETE FROM "ignored_initiative";
+      DELETE FROM "non_voter";
+      DELETE FROM "direct_voter" USING "issue"
+        WHERE "direct_voter"."issue_id" = "issue"."id"
+        AND "issue"."closed" ISNULL;
+      DELETE FROM "event_processed";
+      DELETE FROM "notification_initiative_sent";
+      DELETE FROM "newsletter";
+      DELETE FROM "data_change";
+      RETURN;
+    END;
+  $$;
+
+DROP TRIGGER "send_notify" ON "event";
+DROP TRIGGER "send_notify_on_update" ON "event";
+DROP TRIGGER "log_data_change" ON "event";
+DROP TRIGGER "log_data_change_on_update" ON "event";
+DROP TRIGGER "log_data_change_on_delete" ON "event";
+ALTER SEQUENCE "event_id_seq" OWNED BY NONE;
+ALTER TABLE "event" RENAME TO "event_unpartitioned";
+ALTER INDEX "event_pkey" RENAME TO "event_unpartitioned_pkey";
+ALTER INDEX "event_occurrence_idx" RENAME TO "event_unpartitioned_occurrence_idx";
+
+CREATE TABLE "event" (
+        PRIMARY KEY ("id", "occurrence"),
+        "id"                    INT8            NOT NULL DEFAULT nextval('"event_id_seq"'),
+        "occurrence"            TIMESTAMPTZ     NOT NULL DEFAULT now(),
+        "event"                 "event_type"    NOT NULL,
+        "posting_id"            INT8            REFERENCES "posting" ("id") ON DELETE RESTRICT ON UPDATE CASCADE,
+        "member_id"             INT4            REFERENCES "member" ("id") ON DELETE RESTRICT ON UPDATE CASCADE,
+        "other_member_id"       INT4            REFERENCES "member" ("id") ON DELETE RESTRICT ON UPDATE CASCADE,
+        "scope"                 "delegation_scope",
+        "unit_id"               INT4            REFERENCES "unit" ("id") ON DELETE CASCADE ON UPDATE CASCADE,
+        "area_id"               INT4,
+        FOREIGN KEY ("unit_id", "area_id") REFERENCES "area" ("unit_id", "id") ON DELETE CASCADE ON UPDATE CASCADE,
+        "policy_id"             INT4            REFERENCES "policy" ("id") ON DELETE CASCADE ON UPDATE CASCADE,
+        "issue_id"              INT4            REFERENCES "issue" ("id") ON DELETE CASCADE ON UPDATE CASCADE,
+        FOREIGN KEY ("area_id", "issue_id") REFERENCES "issue" ("area_id", "id") ON DELETE CASCADE ON UPDATE CASCADE,
+        FOREIGN KEY ("policy_id", "issue_id") REFERENCES "issue" ("policy_id", "id") ON DELETE CASCADE ON UPDATE CASCADE,
+        "state"                 "issue_state",
+        "initiative_id"         INT4,
+        "draft_id"              INT8,
+        "suggestion_id"         INT8,
+        "boolean_value"         BOOLEAN,
+        "numeric_value"         INT4,
+        "text_value"            TEXT,
+        "old_text_value"        TEXT,
+        FOREIGN KEY ("issue_id", "initiative_id")
+          REFERENCES "initiative" ("issue_id", "id")
+          ON DELETE CASCADE ON UPDATE CASCADE,
+        FOREIGN KEY ("initiative_id", "draft_id")
+          REFERENCES "draft" ("initiative_id", "id")
+          ON DELETE CASCADE ON UPDATE CASCADE,
+        -- NOTE: no referential integrity for suggestions because those are
+        --       actually deleted
+        -- FOREIGN KEY ("initiative_id", "suggestion_id")
+        --   REFERENCES "suggestion" ("initiative_id", "id")
+        --   ON DELETE CASCADE ON UPDATE CASCADE,
+        CONSTRAINT "constr_for_issue_state_changed" CHECK (
+          "event" != 'issue_state_changed' OR (
+            "posting_id"      ISNULL  AND
+            "member_id"       ISNULL  AND
+            "other_member_id" ISNULL  AND
+            "scope"           ISNULL  AND
+            "unit_id"         NOTNULL AND
+            "area_id"         NOTNULL AND
+            "policy_id"       NOTNULL AND
+            "issue_id"        NOTNULL AND
+            "state"           NOTNULL AND
+            "initiative_id"   ISNULL  AND
+            "draft_id"        ISNULL  AND
+            "suggestion_id"   ISNULL  AND
+            "boolean_value"   ISNULL  AND
+            "numeric_value"   ISNULL  AND
+            "text_value"      ISNULL  AND
+            "old_text_value"  ISNULL )),
+        CONSTRAINT "constr_for_initiative_creation_or_revocation_or_new_draft" CHECK (
+          "event" NOT IN (
+            'initiative_created_in_new_issue',
+            'initiative_created_in_existing_issue',
+            'initiative_revoked',
+            'new_draft_created'
+          ) OR (
+            "posting_id"      ISNULL  AND
+            "member_id"       NOTNULL AND
+            "other_member_id" ISNULL  AND
+            "scope"           ISNULL  AND
+            "unit_id"         NOTNULL AND
+            "area_id"         NOTNULL AND
+            "policy_id"       NOTNULL AND
+            "issue_id"        NOTNULL AND
+            "state"           NOTNULL AND
+            "initiative_id"   NOTNULL AND
+            "draft_id"        NOTNULL AND
+            "suggestion_id"   ISNULL  AND
+            "boolean_value"   ISNULL  AND
+            "numeric_value"   ISNULL  AND
+            "text_value"      ISNULL  AND
+            "old_text_value"  ISNULL )),
+        CONSTRAINT "constr_for_suggestion_creation" CHECK (
+          "event" != 'suggestion_created' OR (
+            "posting_id"      ISNULL  AND
+            "member_id"       NOTNULL AND
+            "other_member_id" ISNULL  AND
+            "scope"           ISNULL  AND
+            "unit_id"         NOTNULL AND
+            "area_id"         NOTNULL AND
+            "policy_id"       NOTNULL AND
+            "issue_id"        NOTNULL AND
+            "state"           NOTNULL AND
+            "initiative_id"   NOTNULL AND
+            "draft_id"        ISNULL  AND
+            "suggestion_id"   NOTNULL AND
+            "boolean_value"   ISNULL  AND
+            "numeric_value"   ISNULL  AND
+            "text_value"      ISNULL  AND
+            "old_text_value"  ISNULL )),
+        CONSTRAINT "constr_for_suggestion_removal" CHECK (
+          "event" != 'suggestion_deleted' OR (
+            "posting_id"      ISNULL  AND
+            "member_id"       ISNULL AND
+            "other_member_id" ISNULL  AND
+            "scope"           ISNULL  AND
+            "unit_id"         NOTNULL AND
+            "area_id"         NOTNULL AND
+            "policy_id"       NOTNULL AND
+            "issue_id"        NOTNULL AND
+            "state"           NOTNULL AND
+            "initiative_id"   NOTNULL AND
+            "draft_id"        ISNULL  AND
+            "suggestion_id"   NOTNULL AND
+            "boolean_value"   ISNULL  AND
+            "numeric_value"   ISNULL  AND
+            "text_value"      ISNULL  AND
+            "old_text_value"  ISNULL )),
+        CONSTRAINT "constr_for_value_less_member_event" CHECK (
+          "event" NOT IN (
+            'member_activated',
+            'member_deleted',
+            'member_profile_updated',
+            'member_image_updated'
+          ) OR (
+            "posting_id"      ISNULL  AND
+            "member_id"       NOTNULL AND
+            "other_member_id" ISNULL  AND
+            "scope"           ISNULL  AND
+            "unit_id"         ISNULL  AND
+            "area_id"         ISNULL  AND
+            "policy_id"       ISNULL  AND
+            "issue_id"        ISNULL  AND
+            "state"           ISNULL  AND
+            "initiative_id"   ISNULL  AND
+            "draft_id"        ISNULL  AND
+            "suggestion_id"   ISNULL  AND
+            "boolean_value"   ISNULL  AND
+            "numeric_value"   ISNULL  AND
+            "text_value"      ISNULL  AND
+            "old_text_value"  ISNULL )),
+        CONSTRAINT "constr_for_member_active" CHECK (
+          "event" != 'member_active' OR (
+            "posting_id"      ISNULL  AND
+            "member_id"       NOTNULL AND
+            "other_member_id" ISNULL  AND
+            "scope"           ISNULL  AND
+            "unit_id"         ISNULL  AND
+            "area_id"         ISNULL  AND
+            "policy_id"       ISNULL  AND
+            "issue_id"        ISNULL  AND
+            "state"           ISNULL  AND
+            "initiative_id"   ISNULL  AND
+            "draft_id"        ISNULL  AND
+            "suggestion_id"   ISNULL  AND
+            "boolean_value"   NOTNULL AND
+            "numeric_value"   ISNULL  AND
+            "text_value"      ISNULL  AND
+            "old_text_value"  ISNULL )),
+        CONSTRAINT "constr_for_member_name_updated" CHECK (
+          "event" != 'member_name_updated' OR (
+            "posting_id"      ISNULL  AND
+            "member_id"       NOTNULL AND
+            "other_member_id" ISNULL  AND
+            "scope"           ISNULL  AND
+            "unit_id"         ISNULL  AND
+            "area_id"         ISNULL  AND
+            "policy_id"       ISNULL  AND
+            "issue_id"        ISNULL  AND
+            "state"           ISNULL  AND
+            "initiative_id"   ISNULL  AND
+            "draft_id"        ISNULL  AND
+            "suggestion_id"   ISNULL  AND
+            "boolean_value"   ISNULL  AND
+            "numeric_value"   ISNULL  AND
+            "text_value"      NOTNULL AND
+            "old_text_value"  NOTNULL )),
+        CONSTRAINT "constr_for_interest" CHECK (
+          "event" != 'interest' OR (
+            "posting_id"      ISNULL  AND
+            "member_id"       NOTNULL AND
+            "other_member_id" ISNULL  AND
+            "scope"           ISNULL  AND
+            "unit_id"         NOTNULL AND
+            "area_id"         NOTNULL AND
+            "policy_id"       NOTNULL AND
+            "issue_id"        NOTNULL AND
+            "state"           NOTNULL AND
+            "initiative_id"   ISNULL  AND
+            "draft_id"        ISNULL  AND
+            "suggestion_id"   ISNULL  AND
+            "boolean_value"   NOTNULL AND
+            "numeric_value"   ISNULL  AND
+            "text_value"      ISNULL  AND
+            "old_text_value"  ISNULL )),
+        CONSTRAINT "constr_for_initiator" CHECK (
+          "event" != 'initiator' OR (
+            "posting_id"      ISNULL  AND
+            "member_id"       NOTNULL AND
+            "other_member_id" ISNULL  AND
+            "scope"           ISNULL  AND
+            "unit_id"         NOTNULL AND
+            "area_id"         NOTNULL AND
+            "policy_id"       NOTNULL AND
+            "issue_id"        NOTNULL AND
+            "state"           NOTNULL AND
+            "initiative_id"   NOTNULL AND
+            "draft_id"        ISNULL  AND
+            "suggestion_id"   ISNULL  AND
+            "boolean_value"   NOTNULL AND
+            "numeric_value"   ISNULL  AND
+            "text_value"      ISNULL  AND
+            "old_text_value"  ISNULL )),
+        CONSTRAINT "constr_for_support" CHECK (
+          "event" != 'support' OR (
+            "posting_id"      ISNULL  AND
+            "member_id"       NOTNULL AND
+            "other_member_id" ISNULL  AND
+            "scope"           ISNULL  AND
+            "unit_id"         NOTNULL AND
+            "area_id"         NOTNULL AND
+            "policy_id"       NOTNULL AND
+            "issue_id"        NOTNULL AND
+            "state"           NOTNULL AND
+            "initiative_id"   NOTNULL AND
+            ("draft_id" NOTNULL) = ("boolean_value" = TRUE) AND
+            "suggestion_id"   ISNULL  AND
+            "boolean_value"   NOTNULL AND
+            "numeric_value"   ISNULL  AND
+            "text_value"      ISNULL  AND
+            "old_text_value"  ISNULL )),
+        CONSTRAINT "constr_for_support_updated" CHECK (
+          "event" != 'support_updated' OR (
+            "posting_id"      ISNULL  AND
+            "member_id"       NOTNULL AND
+            "other_member_id" ISNULL  AND
+            "scope"           ISNULL  AND
+            "unit_id"         NOTNULL AND
+            "area_id"         NOTNULL AND
+            "policy_id"       NOTNULL AND
+            "issue_id"        NOTNULL AND
+            "state"           NOTNULL AND
+            "initiative_id"   NOTNULL AND
+            "draft_id"        NOTNULL AND
+            "suggestion_id"   ISNULL  AND
+            "boolean_value"   ISNULL  AND
+            "numeric_value"   ISNULL  AND
+            "text_value"      ISNULL  AND
+            "old_text_value"  ISNULL )),
+        CONSTRAINT "constr_for_suggestion_rated" CHECK (
+          "event" != 'suggestion_rated' OR (
+            "posting_id"      ISNULL  AND
+            "member_id"       NOTNULL AND
+            "other_member_id" ISNULL  AND
+            "scope"           ISNULL  AND
+            "unit_id"         NOTNULL AND
+            "area_id"         NOTNULL AND
+            "policy_id"       NOTNULL AND
+            "issue_id"        NOTNULL AND
+            "state"           NOTNULL AND
+            "initiative_id"   NOTNULL AND
+            "draft_id"        ISNULL  AND
+            "suggestion_id"   NOTNULL AND
+            ("boolean_value" NOTNULL) = ("numeric_value" != 0) AND
+            "numeric_value"   NOTNULL AND
+            "numeric_value" IN (-2, -1, 0, 1, 2) AND
+            "text_value"      ISNULL  AND
+            "old_text_value"  ISNULL )),
+        CONSTRAINT "constr_for_delegation" CHECK (
+          "event" != 'delegation' OR (
+            "posting_id"      ISNULL  AND
+            "member_id"       NOTNULL AND
+            (("other_member_id" ISNULL) OR ("boolean_value" = TRUE)) AND
+            "scope"           NOTNULL AND
+            "unit_id"         NOTNULL AND
+            ("area_id"  NOTNULL) = ("scope" != 'unit'::"delegation_scope") AND
+            "policy_id"       ISNULL  AND
+            ("issue_id" NOTNULL) = ("scope" = 'issue'::"delegation_scope") AND
+            ("state"    NOTNULL) = ("scope" = 'issue'::"delegation_scope") AND
+            "initiative_id"   ISNULL  AND
+            "draft_id"        ISNULL  AND
+            "suggestion_id"   ISNULL  AND
+            "boolean_value"   NOTNULL AND
+            "numeric_value"   ISNULL  AND
+            "text_value"      ISNULL  AND
+            "old_text_value"  ISNULL )),
+        CONSTRAINT "constr_for_contact" CHECK (
+          "event" != 'contact' OR (
+            "posting_id"      ISNULL  AND
+            "member_id"       NOTNULL AND
+            "other_member_id" NOTNULL AND
+            "scope"           ISNULL  AND
+            "unit_id"         ISNULL  AND
+            "area_id"         ISNULL  AND
+            "policy_id"       ISNULL  AND
+            "issue_id"        ISNULL  AND
+            "state"           ISNULL  AND
+            "initiative_id"   ISNULL  AND
+            "draft_id"        ISNULL  AND
+            "suggestion_id"   ISNULL  AND
+            "boolean_value"   NOTNULL AND
+            "numeric_value"   ISNULL  AND
+            "text_value"      ISNULL  AND
+            "old_text_value"  ISNULL )),
+        CONSTRAINT "constr_for_posting_created" CHECK (
+          "event" != 'posting_created' OR (
+            "posting_id"      NOTNULL AND
+            "member_id"       NOTNULL AND
+            "other_member_id" ISNULL  AND
+            "scope"           ISNULL  AND
+            "state"           ISNULL  AND
+            ("area_id" ISNULL OR "unit_id" NOTNULL) AND
+            ("policy_id" NOTNULL) = ("issue_id" NOTNULL) AND
+            ("issue_id" ISNULL OR "area_id" NOTNULL) AND
+            ("state" NOTNULL) = ("issue_id" NOTNULL) AND
+            ("initiative_id" ISNULL OR "issue_id" NOTNULL) AND
+            "draft_id"        ISNULL  AND
+            ("suggestion_id" ISNULL OR "initiative_id" NOTNULL) AND
+            "boolean_value"   ISNULL  AND
+            "numeric_value"   ISNULL  AND
+            "text_value"      ISNULL  AND
+            "old_text_value"  ISNULL )) )
+  PARTITION BY RANGE ("occurrence");
+CREATE INDEX "event_occurrence_idx" ON "event" ("occurrence");
+ALTER SEQUENCE "event_id_seq" OWNED BY "event"."id";
+
+COMMENT ON TABLE "event" IS 'Event table, automatically filled by triggers; Partitioned by "occurrence" into one partition per month (named "event_YYYY_MM", created by function "create_event_partitions"), such that queries restricted to recent events only need to access recent partitions, and such that old partitions can be archived (see function "detach_event_partitions")';
+
+COMMENT ON COLUMN "event"."id"         IS 'Unique (but not enforced by an index, as the primary key must contain the partitioning column "occurrence")';
+
+CREATE TABLE "event_default" PARTITION OF "event" DEFAULT;
+
+COMMENT ON TABLE "event_default" IS 'Partition of table "event" for events not covered by a monthly partition (rows are moved to the monthly partition when it is created by function "create_event_partitions")';
+
+CREATE FUNCTION "create_event_partitions"()
+  RETURNS VOID
+  LANGUAGE 'plpgsql' VOLATILE AS $$
+    DECLARE
+      "month_v" TIMESTAMPTZ;
+      "name_v"  TEXT;
+    BEGIN
+      PERFORM "dont_require_transaction_isolation"();
+      FOR "month_v" IN
+        SELECT generate_series(
+          date_trunc('month', now()),
+          date_trunc('month', now()) + '1 month'::INTERVAL,
+          '1 month'::INTERVAL )
+      LOOP
+        "name_v" := 'event_' || to_char("month_v", 'YYYY_MM');
+        CONTINUE WHEN to_regclass(format('%I', "name_v")) NOTNULL;
+        EXECUTE format(
+          'CREATE TABLE %I (LIKE "event" INCLUDING DEFAULTS INCLUDING CONSTRAINTS)',
+          "name_v" );
+        EXECUTE format(
+          'WITH "moved" AS (DELETE FROM "event_default" WHERE "occurrence" >= %L AND "occurrence" < %L RETURNING *) INSERT INTO %I SELECT * FROM "moved"',
+          "month_v", "month_v" + '1 month'::INTERVAL, "name_v" );
+        EXECUTE format(
+          'ALTER TABLE "event" ATTACH PARTITION %I FOR VALUES FROM (%L) TO (%L)',
+          "name_v", "month_v", "month_v" + '1 month'::INTERVAL );
+      END LOOP;
+      RETURN;
+    END;
+  $$;
+
+COMMENT ON FUNCTION "create_event_partitions"() IS 'Creates the partitions of table "event" for the current and the next month, if not existent, moving matching rows out of partition "event_default"';
+
+
+CREATE FUNCTION "detach_event_partitions"
+  ( "older_than_p" TIMESTAMPTZ )
+  RETURNS SETOF TEXT
+  LANGUAGE 'plpgsql' VOLATILE AS $$
+    DECLARE
+      "name_v" TEXT;
+    BEGIN
+      PERFORM "dont_require_transaction_isolation"();
+      FOR "name_v" IN
+        SELECT "pg_class"."relname" FROM "pg_inherits"
+        JOIN "pg_class" ON "pg_class"."oid" = "pg_inherits"."inhrelid"
+        WHERE "pg_inherits"."inhparent" = 'event'::REGCLASS
+        AND substring(
+          pg_get_expr("pg_class"."relpartbound", "pg_class"."oid"),
+          'TO \(''([^'']*)''\)'
+        )::TIMESTAMPTZ <= "older_than_p"
+        ORDER BY "pg_class"."relname"
+      LOOP
+        EXECUTE format('ALTER TABLE "event" DETACH PARTITION %I', "name_v");
+        RETURN NEXT "name_v";
+      END LOOP;
+      RETURN;
+    END;
+  $$;
+
+COMMENT ON FUNCTION "detach_event_partitions"(TIMESTAMPTZ) IS 'Detaches all partitions of table "event" which only contain events that occurred before the given point in time, and returns the names of the detached tables, which are to be archived and dropped afterwards (see lf_archive_events script); Events of detached partitions are no longer visible through table "event"';
+
+DO $$
+  DECLARE
+    "month_v" TIMESTAMPTZ;
+  BEGIN
+    FOR "month_v" IN
+      SELECT DISTINCT date_trunc('month', "occurrence")
+      FROM "event_unpartitioned"
+    LOOP
+      EXECUTE format(
+        'CREATE TABLE %I PARTITION OF "event" FOR VALUES FROM (%L) TO (%L)',
+        'event_' || to_char("month_v", 'YYYY_MM'),
+        "month_v", "month_v" + '1 month'::INTERVAL );
+    END LOOP;
+  END;
+$$;
+
+SELECT "create_event_partitions"();
+
+INSERT INTO "event" SELECT * FROM "event_unpartitioned";
+
+CREATE OR REPLACE VIEW "event_for_notification" AS
+  SELECT
+    "member"."id" AS "recipient_id",
+    "event".*
+  FROM "member" CROSS JOIN "event"
+  JOIN "issue" ON "issue"."id" = "event"."issue_id"
+  JOIN "area" ON "area"."id" = "issue"."area_id"
+  LEFT JOIN "privilege" ON
+    "privilege"."member_id" = "member"."id" AND
+    "privilege"."unit_id" = "area"."unit_id"
+  LEFT JOIN "issue_privilege" ON
+    "issue_privilege"."member_id" = "member"."id" AND
+    "issue_privilege"."issue_id" = "event"."issue_id"
+  LEFT JOIN "subscription" ON
+    "subscription"."member_id" = "member"."id" AND
+    "subscription"."unit_id" = "area"."unit_id"
+  LEFT JOIN "ignored_area" ON
+    "ignored_area"."member_id" = "member"."id" AND
+    "ignored_area"."area_id" = "issue"."area_id"
+  LEFT JOIN "interest" ON
+    "interest"."member_id" = "member"."id" AND
+    "interest"."issue_id" = "event"."issue_id"
+  LEFT JOIN "supporter" ON
+    "supporter"."member_id" = "member"."id" AND
+    "supporter"."initiative_id" = "event"."initiative_id"
+  WHERE (
+    COALESCE("issue_privilege"."voting_right", "privilege"."voting_right") OR
+    "subscription"."member_id" NOTNULL
+  ) AND ("ignored_area"."member_id" ISNULL OR "interest"."member_id" NOTNULL)
+  AND (
+    "event"."event" = 'issue_state_changed'::"event_type" OR
+    ( "event"."event" = 'initiative_revoked'::"event_type" AND
+      "supporter"."member_id" NOTNULL ) );
+
+COMMENT ON VIEW "event_for_notification" IS 'Entries of the "event" table which are of interest for a particular notification mail recipient; Queries should restrict column "occurrence" (in addition to "id"), such that only recent partitions of table "event" are accessed';
+
+DROP TABLE "event_unpartitioned";
+
+CREATE TRIGGER "send_notify"
+  AFTER INSERT ON "event" REFERENCING NEW TABLE AS "new_event"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "send_event_notify_trigger"();
+
+CREATE TRIGGER "send_notify_on_update"
+  AFTER UPDATE ON "event" REFERENCING NEW TABLE AS "new_event"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "send_event_notify_trigger"();
+
+COMMENT ON TRIGGER "send_notify"           ON "event" IS 'Sends a NOTIFY on channel "event" with the event type as payload, once for each distinct event type inserted by a statement';
+COMMENT ON TRIGGER "send_notify_on_update" ON "event" IS 'Sends a NOTIFY on channel "event" with the event type as payload, once for each distinct event type updated by a statement';
+
+CREATE TRIGGER "log_data_change"
+  AFTER INSERT ON "event"
+  REFERENCING NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change_on_update"
+  AFTER UPDATE ON "event"
+  REFERENCING OLD TABLE AS "old_rows" NEW TABLE AS "new_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+CREATE TRIGGER "log_data_change_on_delete"
+  AFTER DELETE ON "event"
+  REFERENCING OLD TABLE AS "old_rows"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_data_change_trigger"('id');
+
+COMMENT ON TRIGGER "log_data_change"           ON "event" IS 'Log keys of rows inserted by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_update" ON "event" IS 'Log old and new keys of rows updated by a statement in table "data_change" for incremental exports';
+COMMENT ON TRIGGER "log_data_change_on_delete" ON "event" IS 'Log keys of rows deleted by a statement in table "data_change" for incremental exports';
+
+ALTER TABLE "event_processed" ADD COLUMN "occurrence" TIMESTAMPTZ;
+
+COMMENT ON COLUMN "event_processed"."occurrence" IS 'Occurrence of the event referenced by "event_id", used by function "get_events_for_notification" to only access recent partitions of table "event"; Must be set to NULL (or an earlier point in time) when "event_id" is decreased by other means';
+
+DROP TRIGGER "update_posting_lexeme" ON "posting";
+
+CREATE FUNCTION "posting_lexemes"("message_p" TEXT)
+  RETURNS SETOF TEXT
+  LANGUAGE SQL IMMUTABLE AS $$
+    SELECT DISTINCT "match"[1]
+    FROM regexp_matches("message_p", '#[^\s.,;:]+', 'g') AS "match"
+  $$;
+
+COMMENT ON FUNCTION "posting_lexemes"(TEXT) IS 'Hashtags contained in a posting message';
+
+
+CREATE OR REPLACE FUNCTION "update_posting_lexeme_trigger"()
+  RETURNS TRIGGER
+  LANGUAGE 'plpgsql' VOLATILE AS $$
+    BEGIN
+      IF TG_OP = 'INSERT' THEN
+        INSERT INTO "posting_lexeme" ("posting_id", "author_id", "lexeme")
+          SELECT "new_posting"."id", "new_posting"."author_id", "lexeme"
+          FROM "new_posting",
+          "posting_lexemes"("new_posting"."message") AS "lexeme"
+          ON CONFLICT ("posting_id", "lexeme") DO NOTHING;
+      ELSE
+        -- only postings with changed messages are considered, and only
+        -- lexemes which have been removed or added are deleted or inserted
+        -- (changes of "id" or "author_id" are cascaded by the foreign key):
+        DELETE FROM "posting_lexeme" USING "new_posting"
+          WHERE "posting_lexeme"."posting_id" = "new_posting"."id"
+          AND NOT EXISTS (
+            SELECT NULL FROM "old_posting"
+            WHERE "old_posting"."id" = "new_posting"."id"
+            AND "old_posting"."message" = "new_posting"."message" )
+          AND "posting_lexeme"."lexeme" NOT IN (
+            SELECT "posting_lexemes"("new_posting"."message") );
+        INSERT INTO "posting_lexeme" ("posting_id", "author_id", "lexeme")
+          SELECT "new_posting"."id", "new_posting"."author_id", "lexeme"
+          FROM "new_posting",
+          "posting_lexemes"("new_posting"."message") AS "lexeme"
+          WHERE NOT EXISTS (
+            SELECT NULL FROM "old_posting"
+            WHERE "old_posting"."id" = "new_posting"."id"
+            AND "old_posting"."message" = "new_posting"."message" )
+          ON CONFLICT ("posting_id", "lexeme") DO NOTHING;
+      END IF;
+      RETURN NULL;
+    END;
+  $$;
+
+CREATE TRIGGER "update_posting_lexeme"
+  AFTER INSERT ON "posting" REFERENCING NEW TABLE AS "new_posting"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "update_posting_lexeme_trigger"();
+
+CREATE TRIGGER "update_posting_lexeme_on_update"
+  AFTER UPDATE ON "posting"
+  REFERENCING OLD TABLE AS "old_posting" NEW TABLE AS "new_posting"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "update_posting_lexeme_trigger"();
+
+COMMENT ON FUNCTION "update_posting_lexeme_trigger"()             IS 'Implementation of triggers "update_posting_lexeme" and "update_posting_lexeme_on_update" on table "posting"';
+COMMENT ON TRIGGER "update_posting_lexeme"           ON "posting" IS 'Inserts the lexemes of all postings inserted by a statement into table "posting_lexeme" (lexemes of deleted postings are deleted by the foreign key of "posting_lexeme")';
+COMMENT ON TRIGGER "update_posting_lexeme_on_update" ON "posting" IS 'Updates table "posting_lexeme" for all postings whose message has been changed by a statement';
+
+-- lf_migrate: batch "posting"
+INSERT INTO "posting_lexeme" ("posting_id", "author_id", "lexeme")
+  SELECT "posting"."id", "posting"."author_id", "lexeme"
+  FROM "posting", "posting_lexemes"("posting"."message") AS "lexeme"
+  ON CONFLICT ("posting_id", "lexeme") DO NOTHING;
+
+-- final pass for postings which have been moved to already processed
+-- blocks by an update while lf_migrate processed the batches above (no-op
+-- when applied with psql):
+INSERT INTO "posting_lexeme" ("posting_id", "author_id", "lexeme")
+  SELECT "posting"."id", "posting"."author_id", "lexeme"
+  FROM "posting", "posting_lexemes"("posting"."message") AS "lexeme"
+  WHERE NOT EXISTS (
+    SELECT NULL FROM "posting_lexeme"
+    WHERE "posting_lexeme"."posting_id" = "posting"."id" )
+  ON CONFLICT ("posting_id", "lexeme") DO NOTHING;
+
+COMMENT ON FUNCTION "featured_initiative"
+  ( "recipient_id_p" "member"."id"%TYPE,
+    "area_id_p"      "area"."id"%TYPE )
+  IS 'Helper function for view "updated_or_featured_initiative"; Function "get_initiatives_for_notification_batch" performs the same selection for several recipients at once (using function "featured_initiative_selection") and must be kept consistent with this function';
+
+CREATE FUNCTION "featured_initiative_selection"
+  ( "initiative_id_ary_p" INT4[],
+    "supporter_id_ary_p"  INT4[],
+    "sample_size_p"       INT4 )
+  RETURNS SETOF INT4
+  LANGUAGE 'plpgsql' IMMUTABLE AS $$
+    DECLARE
+      "initiative_id_ary" INT4[];  --"initiative"."id"%TYPE[]
+      "match_v"           BOOLEAN;
+      "index_v"           INT4;
+      "supporter_id_v"    INT4;
+    BEGIN
+      "initiative_id_ary" := '{}';
+      LOOP
+        "match_v" := FALSE;
+        "index_v" := 1;
+        WHILE "index_v" <= array_length("initiative_id_ary_p", 1) LOOP
+          IF "initiative_id_ary" @> ARRAY["initiative_id_ary_p"["index_v"]] THEN
+            "index_v" := "index_v" + 1;
+          ELSE
+            "match_v" := TRUE;
+            RETURN NEXT "initiative_id_ary_p"["index_v"];
+            IF array_length("initiative_id_ary", 1) + 1 >= "sample_size_p" THEN
+              RETURN;
+            END IF;
+            "initiative_id_ary" :=
+              "initiative_id_ary" || "initiative_id_ary_p"["index_v"];
+            -- skip remaining candidates of the same supporter:
+            "supporter_id_v" := "supporter_id_ary_p"["index_v"];
+            WHILE "supporter_id_ary_p"["index_v"] = "supporter_id_v" LOOP
+              "index_v" := "index_v" + 1;
+            END LOOP;
+          END IF;
+        END LOOP;
+        EXIT WHEN NOT "match_v";
+      END LOOP;
+      RETURN;
+    END;
+  $$;
+
+COMMENT ON FUNCTION "featured_initiative_selection"
+  ( INT4[], INT4[], INT4 )
+  IS 'Helper function for function "get_initiatives_for_notification_batch", which selects featured initiatives for one recipient and area in the same way as function "featured_initiative" does; Expects all eligible pairs of supporters and initiatives, ordered by the seed of the supporter and then by the seed of the initiative';
+
+
+CREATE FUNCTION "get_initiatives_for_notification_batch"
+  ( "recipient_count_p" INT4 )
+  RETURNS SETOF "initiative_for_notification"
+  LANGUAGE 'plpgsql' VOLATILE AS $$
+    DECLARE
+      "recipient_id_ary" INT4[];  --"member"."id"%TYPE[]
+    BEGIN
+      PERFORM "require_transaction_isolation"();
+      SELECT array_agg("recipient_id") INTO "recipient_id_ary" FROM (
+        SELECT "recipient_id" FROM "scheduled_notification_to_send"
+        ORDER BY "pending" DESC, "recipient_id" LIMIT "recipient_count_p"
+      ) AS "subquery";
+      IF "recipient_id_ary" ISNULL THEN
+        RETURN;
+      END IF;
+      PERFORM NULL FROM "member" WHERE "id" = ANY("recipient_id_ary")
+        ORDER BY "id" FOR UPDATE;
+      RETURN QUERY WITH
+      "featured_candidate" AS (
+        SELECT
+          "member"."id" AS "recipient_id",
+          "issue"."area_id",
+          "member"."notification_sample_size" AS "sample_size",
+          "supporter"."member_id" AS "supporter_id",
+          "initiative"."id" AS "initiative_id",
+          md5(
+            "member"."id"                   || '-' ||
+            "member"."notification_counter" || '-' ||
+            "issue"."area_id"               || '-' ||
+            "supporter"."member_id"
+          ) AS "seed"
+        FROM "member"
+        CROSS JOIN "issue"
+        JOIN "area" ON "area"."id" = "issue"."area_id"
+        JOIN "initiative" ON "initiative"."issue_id" = "issue"."id"
+        JOIN "supporter" ON "supporter"."initiative_id" = "initiative"."id"
+        LEFT JOIN "supporter" AS "self_support" ON
+          "self_support"."initiative_id" = "initiative"."id" AND
+          "self_support"."member_id" = "member"."id"
+        LEFT JOIN "privilege" ON
+          "privilege"."member_id" = "member"."id" AND
+          "privilege"."unit_id" = "area"."unit_id"
+        LEFT JOIN "issue_privilege" ON
+          "issue_privilege"."member_id" = "member"."id" AND
+          "issue_privilege"."issue_id" = "issue"."id"
+        LEFT JOIN "subscription" ON
+          "subscription"."member_id" = "member"."id" AND
+          "subscription"."unit_id" = "area"."unit_id"
+        LEFT JOIN "ignored_initiative" ON
+          "ignored_initiative"."member_id" = "member"."id" AND
+          "ignored_initiative"."initiative_id" = "initiative"."id"
+        WHERE "member"."id" = ANY("recipient_id_ary")
+        AND "member"."notification_sample_size" > 0
+        AND "supporter"."member_id" != "member"."id"
+        AND "issue"."state" IN ('admission', 'discussion', 'verification')
+        AND "initiative"."revoked" ISNULL
+        AND "self_support"."member_id" ISNULL
+        AND (
+          COALESCE(
+            "issue_privilege"."voting_right", "privilege"."voting_right"
+          ) OR "subscription"."member_id" NOTNULL )
+        AND "ignored_initiative"."member_id" ISNULL
+        AND NOT EXISTS (
+          SELECT NULL FROM "draft"
+          JOIN "ignored_member" ON
+            "ignored_member"."member_id" = "member"."id" AND
+            "ignored_member"."other_member_id" = "draft"."author_id"
+          WHERE "draft"."initiative_id" = "initiative"."id"
+        )
+      ),
+      "featured_initiative" AS (
+        SELECT
+          "subquery"."recipient_id",
+          TRUE AS "featured",
+          "featured_initiative_id" AS "initiative_id"
+        FROM (
+          SELECT
+            "recipient_id",
+            "sample_size",
+            array_agg("initiative_id" ORDER BY
+              "seed", md5("seed" || '-' || "initiative_id")
+            ) AS "initiative_id_ary",
+            array_agg("supporter_id" ORDER BY
+              "seed", md5("seed" || '-' || "initiative_id")
+            ) AS "supporter_id_ary"
+          FROM "featured_candidate"
+          GROUP BY "recipient_id", "area_id", "sample_size"
+        ) AS "subquery"
+        CROSS JOIN LATERAL "featured_initiative_selection"(
+          "subquery"."initiative_id_ary",
+          "subquery"."supporter_id_ary",
+          "subquery"."sample_size"
+        ) AS "featured_initiative_id"
+      ),
+      "uf_initiative" AS (
+        SELECT
+          "subquery".*,
+          NOT EXISTS (
+            SELECT NULL FROM "initiative" AS "better_initiative"
+            WHERE "better_initiative"."issue_id" = "initiative"."issue_id"
+            AND
+              ( COALESCE("better_initiative"."supporter_count", -1),
+                -"better_initiative"."id" ) >
+              ( COALESCE("initiative"."supporter_count", -1),
+                -"initiative"."id" )
+          ) AS "leading"
+        FROM (
+          SELECT * FROM "updated_initiative"
+          WHERE "recipient_id" = ANY("recipient_id_ary")
+          UNION ALL
+          SELECT * FROM "featured_initiative"
+        ) AS "subquery"
+        JOIN "initiative" ON "initiative"."id" = "subquery"."initiative_id"
+      ),
+      "leading_complement" AS (
+        SELECT * FROM (
+          SELECT DISTINCT ON ("uf_initiative"."recipient_id", "initiative"."issue_id")
+            "uf_initiative"."recipient_id",
+            FALSE AS "featured",
+            "uf_initiative"."initiative_id",
+            TRUE AS "leading"
+          FROM "uf_initiative"
+          JOIN "initiative" AS "uf_initiative_full" ON
+            "uf_initiative_full"."id" = "uf_initiative"."initiative_id"
+          JOIN "initiative" ON
+            "initiative"."issue_id" = "uf_initiative_full"."issue_id"
+          WHERE "initiative"."revoked" ISNULL
+          ORDER BY
+            "uf_initiative"."recipient_id",
+            "initiative"."issue_id",
+            "initiative"."supporter_count" DESC,
+            "initiative"."id"
+        ) AS "subquery"
+        WHERE NOT EXISTS (
+          SELECT NULL FROM "uf_initiative" AS "other"
+          WHERE "other"."recipient_id" = "subquery"."recipient_id"
+          AND "other"."initiative_id" = "subquery"."initiative_id"
+        )
+      ),
+      "unfiltered" AS (
+        SELECT
+          "subquery".*,
+          "initiative"."issue_id",
+          "supporter"."member_id" NOTNULL AS "supported",
+          CASE WHEN "supporter"."member_id" NOTNULL THEN
+            EXISTS (
+              SELECT NULL FROM "draft"
+              WHERE "draft"."initiative_id" = "subquery"."initiative_id"
+              AND "draft"."id" > "supporter"."draft_id"
+            )
+          ELSE
+            EXISTS (
+              SELECT NULL FROM "draft"
+              WHERE "draft"."initiative_id" = "subquery"."initiative_id"
+              AND COALESCE("draft"."id" > "sent"."last_draft_id", TRUE)
+            )
+          END AS "new_draft",
+          CASE WHEN "supporter"."member_id" NOTNULL THEN
+            ( SELECT count(1) FROM "suggestion"
+              LEFT JOIN "opinion" ON
+                "opinion"."member_id" = "supporter"."member_id" AND
+                "opinion"."suggestion_id" = "suggestion"."id"
+              WHERE "suggestion"."initiative_id" = "subquery"."initiative_id"
+              AND "opinion"."member_id" ISNULL
+              AND COALESCE("suggestion"."id" > "sent"."last_suggestion_id", TRUE)
+            )
+          ELSE
+            ( SELECT count(1) FROM "suggestion"
+              WHERE "suggestion"."initiative_id" = "subquery"."initiative_id"
+              AND COALESCE("suggestion"."id" > "sent"."last_suggestion_id", TRUE)
+            )
+          END AS "new_suggestion_count"
+        FROM (
+          SELECT * FROM "uf_initiative"
+          UNION ALL
+          SELECT * FROM "leading_complement"
+        ) AS "subquery"
+        JOIN "initiative" ON "initiative"."id" = "subquery"."initiative_id"
+        LEFT JOIN "supporter" ON
+          "supporter"."member_id" = "subquery"."recipient_id" AND
+          "supporter"."initiative_id" = "subquery"."initiative_id"
+        LEFT JOIN "notification_initiative_sent" AS "sent" ON
+          "sent"."member_id" = "subquery"."recipient_id" AND
+          "sent"."initiative_id" = "subquery"."initiative_id"
+      ),
+      "result" AS (
+        SELECT
+          "unfiltered1"."recipient_id",
+          "unfiltered1"."featured",
+          "unfiltered1"."initiative_id",
+          "unfiltered1"."leading",
+          "unfiltered1"."supported",
+          "unfiltered1"."new_draft",
+          "unfiltered1"."new_suggestion_count"
+        FROM "unfiltered" AS "unfiltered1"
+        JOIN "issue" AS "issue1" ON "issue1"."id" = "unfiltered1"."issue_id"
+        WHERE EXISTS (
+          SELECT NULL
+          FROM "unfiltered" AS "unfiltered2"
+          JOIN "issue" AS "issue2" ON "issue2"."id" = "unfiltered2"."issue_id"
+          WHERE "unfiltered1"."recipient_id" = "unfiltered2"."recipient_id"
+          AND "issue1"."area_id" = "issue2"."area_id"
+          AND ("unfiltered2"."new_draft" OR "unfiltered2"."new_suggestion_count" > 0 )
+        )
+      ),
+      "updated_sent" AS (
+        INSERT INTO "notification_initiative_sent"
+          ("member_id", "initiative_id", "last_draft_id", "last_suggestion_id")
+          SELECT DISTINCT
+            "result"."recipient_id",
+            "result"."initiative_id",
+            ( SELECT max("id") FROM "draft"
+              WHERE "draft"."initiative_id" = "result"."initiative_id" ),
+            ( SELECT max("id") FROM "suggestion"
+              WHERE "suggestion"."initiative_id" = "result"."initiative_id" )
+          FROM "result"
+          ON CONFLICT ("member_id", "initiative_id") DO UPDATE SET
+            "last_draft_id" = "excluded"."last_draft_id",
+            "last_suggestion_id" = "excluded"."last_suggestion_id"
+      )
+      SELECT * FROM "result"
+      ORDER BY "recipient_id";
+      DELETE FROM "notification_initiative_sent"
+        USING "initiative", "issue"
+        WHERE "notification_initiative_sent"."member_id" = ANY("recipient_id_ary")
+        AND "initiative"."id" = "notification_initiative_sent"."initiative_id"
+        AND "issue"."id" = "initiative"."issue_id"
+        AND ( "issue"."closed" NOTNULL OR "issue"."fully_frozen" NOTNULL );
+      UPDATE "member" SET
+        "notification_counter" = "notification_counter" + 1,
+        "notification_sent" = now()
+        WHERE "id" = ANY("recipient_id_ary");
+      RETURN;
+    END;
+  $$;
+
+COMMENT ON FUNCTION "get_initiatives_for_notification_batch"
+  ( INT4 )
+  IS 'Batch variant of function "get_initiatives_for_notification" for the given number of recipients with the longest pending scheduled notification (see view "scheduled_notification_to_send"): Returns the same rows as the function would return for each of these recipients (ordered by recipient, such that one mail per recipient can be created while reading the result), and updates table "notification_initiative_sent" and table "member" accordingly; Updated and featured initiatives are determined for all recipients at once instead of evaluating the view "initiative_for_notification" for each member (see function "featured_initiative_selection"); Recipients without initiatives to be notified about are processed but do not appear in the result, so the function is to be called repeatedly until "scheduled_notification_to_send" is empty';
+
+ALTER TABLE "direct_voter" ADD COLUMN "ballot_initiative_ids" INT4[] NOT NULL DEFAULT '{}';
+ALTER TABLE "direct_voter" ADD COLUMN "ballot_grades" INT4[] NOT NULL DEFAULT '{}';
+
+COMMENT ON COLUMN "direct_voter"."ballot_initiative_ids" IS 'Packed ballot: Initiatives of all rows in table "vote" of the voter, ordered by their id; Maintained by triggers "update_ballot" on table "vote" and must not be set by frontends';
+COMMENT ON COLUMN "direct_voter"."ballot_grades"         IS 'Packed ballot: Grades corresponding to "ballot_initiative_ids"; Used by "battle_view" and "close_voting" instead of table "vote"';
+
+CREATE FUNCTION "update_ballot_trigger"()
+  RETURNS TRIGGER
+  LANGUAGE 'plpgsql' VOLATILE AS $$
+    DECLARE
+      "issue_ids_v"  INT4[];
+      "member_ids_v" INT4[];
+    BEGIN
+      IF TG_OP = 'INSERT' THEN
+        SELECT INTO "issue_ids_v", "member_ids_v"
+          array_agg("issue_id"), array_agg("member_id")
+          FROM (
+            SELECT DISTINCT "issue_id", "member_id" FROM "new_vote"
+          ) AS "subquery";
+      ELSIF TG_OP = 'DELETE' THEN
+        SELECT INTO "issue_ids_v", "member_ids_v"
+          array_agg("issue_id"), array_agg("member_id")
+          FROM (
+            SELECT DISTINCT "issue_id", "member_id" FROM "old_vote"
+          ) AS "subquery";
+      ELSE
+        -- only voters with changed grades are considered (setting of
+        -- "first_preference" by "close_voting" does not change the ballot):
+        SELECT INTO "issue_ids_v", "member_ids_v"
+          array_agg("issue_id"), array_agg("member_id")
+          FROM (
+            SELECT DISTINCT "issue_id", "member_id" FROM (
+              ( SELECT "issue_id", "member_id", "initiative_id", "grade"
+                FROM "new_vote"
+                EXCEPT ALL
+                SELECT "issue_id", "member_id", "initiative_id", "grade"
+                FROM "old_vote" )
+              UNION ALL
+              ( SELECT "issue_id", "member_id", "initiative_id", "grade"
+                FROM "old_vote"
+                EXCEPT ALL
+                SELECT "issue_id", "member_id", "initiative_id", "grade"
+                FROM "new_vote" )
+            ) AS "changed_vote"
+          ) AS "subquery";
+      END IF;
+      IF "issue_ids_v" NOTNULL THEN
+        -- NOTE: rows of deleted voters (when votes are deleted by the
+        -- foreign key of table "vote") are not updated anymore
+        UPDATE "direct_voter" SET
+          ("ballot_initiative_ids", "ballot_grades") = (
+            SELECT
+              coalesce(array_agg("initiative_id" ORDER BY "initiative_id"), '{}'),
+              coalesce(array_agg("grade" ORDER BY "initiative_id"), '{}')
+            FROM "vote"
+            WHERE "vote"."issue_id" = "direct_voter"."issue_id"
+            AND "vote"."member_id" = "direct_voter"."member_id" )
+          FROM unnest("issue_ids_v", "member_ids_v") AS "voter" ("issue_id", "member_id")
+          WHERE "direct_voter"."issue_id" = "voter"."issue_id"
+          AND "direct_voter"."member_id" = "voter"."member_id";
+      END IF;
+      RETURN NULL;
+    END;
+  $$;
+
+CREATE TRIGGER "update_ballot"
+  AFTER INSERT ON "vote" REFERENCING NEW TABLE AS "new_vote"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "update_ballot_trigger"();
+
+CREATE TRIGGER "update_ballot_on_update"
+  AFTER UPDATE ON "vote"
+  REFERENCING OLD TABLE AS "old_vote" NEW TABLE AS "new_vote"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "update_ballot_trigger"();
+
+CREATE TRIGGER "update_ballot_on_delete"
+  AFTER DELETE ON "vote" REFERENCING OLD TABLE AS "old_vote"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "update_ballot_trigger"();
+
+COMMENT ON FUNCTION "update_ballot_trigger"()            IS 'Implementation of triggers "update_ballot", "update_ballot_on_update", and "update_ballot_on_delete" on table "vote"';
+COMMENT ON TRIGGER "update_ballot"           ON "vote" IS 'Packs the ballots of all voters with votes inserted by a statement into columns "ballot_initiative_ids" and "ballot_grades" of table "direct_voter"';
+COMMENT ON TRIGGER "update_ballot_on_update" ON "vote" IS 'Packs the ballots of all voters whose grades have been changed by a statement';
+COMMENT ON TRIGGER "update_ballot_on_delete" ON "vote" IS 'Packs the ballots of all voters with votes deleted by a statement';
+
+-- lf_migrate: batch "direct_voter"
+UPDATE "direct_voter" SET
+  ("ballot_initiative_ids", "ballot_grades") = (
+    SELECT
+      coalesce(array_agg("initiative_id" ORDER BY "initiative_id"), '{}'),
+      coalesce(array_agg("grade" ORDER BY "initiative_id"), '{}')
+    FROM "vote"
+    WHERE "vote"."issue_id" = "direct_voter"."issue_id"
+    AND "vote"."member_id" = "direct_voter"."member_id" );
+
+-- final pass for voters which have been moved to already processed blocks
+-- by an update (e.g. of their comment) while lf_migrate processed the
+-- batches above, and which still have an empty ballot (no-op when applied
+-- with psql):
+UPDATE "direct_voter" SET
+  ("ballot_initiative_ids", "ballot_grades") = (
+    SELECT
+      coalesce(array_agg("initiative_id" ORDER BY "initiative_id"), '{}'),
+      coalesce(array_agg("grade" ORDER BY "initiative_id"), '{}')
+    FROM "vote"
+    WHERE "vote"."issue_id" = "direct_voter"."issue_id"
+    AND "vote"."member_id" = "direct_voter"."member_id" )
+  WHERE "ballot_initiative_ids" = '{}'
+  AND EXISTS (
+    SELECT NULL FROM "vote"
+    WHERE "vote"."issue_id" = "direct_voter"."issue_id"
+    AND "vote"."member_id" = "direct_voter"."member_id" );
+
+CREATE OR REPLACE FUNCTION "forbid_changes_on_closed_issue_trigger"()
+  RETURNS TRIGGER
+  LANGUAGE 'plpgsql' VOLATILE AS $$
+    DECLARE
+      "issue_id_v" "issue"."id"%TYPE;
+      "issue_row"  "issue"%ROWTYPE;
+    BEGIN
+      IF EXISTS (
+        SELECT NULL FROM "temporary_transaction_data"
+        WHERE "txid" = txid_current()
+        AND "key" = 'override_protection_triggers'
+        AND "value" = TRUE::TEXT
+      ) THEN
+        RETURN NULL;
+      END IF;
+      IF TG_OP = 'DELETE' THEN
+        "issue_id_v" := OLD."issue_id";
+      ELSE
+        "issue_id_v" := NEW."issue_id";
+      END IF;
+      SELECT INTO "issue_row" * FROM "issue"
+        WHERE "id" = "issue_id_v" FOR SHARE;
+      IF (
+        "issue_row"."closed" NOTNULL OR (
+          "issue_row"."state" = 'voting' AND
+          "issue_row"."phase_finished" NOTNULL
+        )
+      ) THEN
+        IF
+          TG_RELID = 'direct_voter'::regclass AND
+          TG_OP = 'UPDATE'
+        THEN
+          IF
+            OLD."issue_id"  = NEW."issue_id"  AND
+            OLD."member_id" = NEW."member_id" AND
+            OLD."weight" = NEW."weight" AND
+            OLD."ballot_initiative_ids" = NEW."ballot_initiative_ids" AND
+            OLD."ballot_grades" = NEW."ballot_grades"
+          THEN
+            RETURN NULL;  -- allows changing of voter comment
+          END IF;
+        END IF;
+        RAISE EXCEPTION 'Tried to modify data after voting has been closed.' USING
+          ERRCODE = 'integrity_constraint_violation';
+      END IF;
+      RETURN NULL;
+    END;
+  $$;
+
+CREATE OR REPLACE VIEW "battle_view" AS
+  SELECT
+    "issue"."id" AS "issue_id",
+    "winning_initiative"."id" AS "winning_initiative_id",
+    "losing_initiative"."id" AS "losing_initiative_id",
+    sum(
+      CASE WHEN
+        coalesce("direct_voter"."ballot_grades"[array_position(
+          "direct_voter"."ballot_initiative_ids", "winning_initiative"."id"
+        )], 0) >
+        coalesce("direct_voter"."ballot_grades"[array_position(
+          "direct_voter"."ballot_initiative_ids", "losing_initiative"."id"
+        )], 0)
+      THEN "direct_voter"."weight" ELSE 0 END
+    ) AS "count"
+  FROM "issue"
+  LEFT JOIN "direct_voter"
+  ON "issue"."id" = "direct_voter"."issue_id"
+  JOIN "battle_participant" AS "winning_initiative"
+    ON "issue"."id" = "winning_initiative"."issue_id"
+  JOIN "battle_participant" AS "losing_initiative"
+    ON "issue"."id" = "losing_initiative"."issue_id"
+  WHERE "issue"."state" = 'voting'
+  AND "issue"."phase_finished" NOTNULL
+  AND (
+    "winning_initiative"."id" != "losing_initiative"."id" OR
+    ( ("winning_initiative"."id" NOTNULL AND "losing_initiative"."id" ISNULL) OR
+      ("winning_initiative"."id" ISNULL AND "losing_initiative"."id" NOTNULL) ) )
+  GROUP BY
+    "issue"."id",
+    "winning_initiative"."id",
+    "losing_initiative"."id";
+
+COMMENT ON VIEW "battle_view" IS 'Number of members preferring one initiative (or status-quo) to another initiative (or status-quo); Used to fill "battle" table; Reads the packed ballots in table "direct_voter" (missing grades and the status-quo count as zero)';
+
+
+CREATE VIEW "unpacked_vote" AS
+  SELECT
+    "direct_voter"."issue_id",
+    "ballot"."initiative_id",
+    "direct_voter"."member_id",
+    "ballot"."grade"
+  FROM "direct_voter",
+  unnest("direct_voter"."ballot_initiative_ids", "direct_voter"."ballot_grades")
+  AS "ballot" ("initiative_id", "grade");
+
+COMMENT ON VIEW "unpacked_vote" IS 'Votes read from the packed ballots in table "direct_voter" (for auditing of results); Contains the same rows as table "vote" (without "first_preference")';
+
+CREATE OR REPLACE FUNCTION "close_voting"("issue_id_p" "issue"."id"%TYPE)
+  RETURNS VOID
+  LANGUAGE 'plpgsql' VOLATILE AS $$
+    DECLARE
+      "area_id_v"   "area"."id"%TYPE;
+      "unit_id_v"   "unit"."id"%TYPE;
+      "member_id_v" "member"."id"%TYPE;
+    BEGIN
+      PERFORM "require_transaction_isolation"();
+      SELECT "area_id" INTO "area_id_v" FROM "issue" WHERE "id" = "issue_id_p";
+      SELECT "unit_id" INTO "unit_id_v" FROM "area"  WHERE "id" = "area_id_v";
+      -- override protection triggers:
+      INSERT INTO "temporary_transaction_data" ("key", "value")
+        VALUES ('override_protection_triggers', TRUE::TEXT);
+      -- delete timestamp of voting comment:
+      UPDATE "direct_voter" SET "comment_changed" = NULL
+        WHERE "issue_id" = "issue_id_p";
+      -- delete delegating votes (in cases of manual reset of issue state):
+      DELETE FROM "delegating_voter"
+        WHERE "issue_id" = "issue_id_p";
+      -- delete votes from non-privileged voters:
+      DELETE FROM "direct_voter"
+        USING (
+          SELECT "direct_voter"."member_id"
+          FROM "direct_voter"
+          JOIN "member" ON "direct_voter"."member_id" = "member"."id"
+          LEFT JOIN "privilege"
+          ON "privilege"."unit_id" = "unit_id_v"
+          AND "privilege"."member_id" = "direct_voter"."member_id"
+          LEFT JOIN "issue_privilege"
+          ON "issue_privilege"."issue_id" = "issue_id_p"
+          AND "issue_privilege"."member_id" = "direct_voter"."member_id"
+          WHERE "direct_voter"."issue_id" = "issue_id_p" AND (
+            "member"."active" = FALSE OR
+            COALESCE(
+              "issue_privilege"."voting_right",
+              "privilege"."voting_right",
+              FALSE
+            ) = FALSE
+          )
+        ) AS "subquery"
+        WHERE "direct_voter"."issue_id" = "issue_id_p"
+        AND "direct_voter"."member_id" = "subquery"."member_id";
+      -- consider voting weight and delegations:
+      UPDATE "direct_voter" SET "ownweight" = "privilege"."weight"
+        FROM "privilege"
+        WHERE "issue_id" = "issue_id_p"
+        AND "privilege"."unit_id" = "unit_id_v"
+        AND "privilege"."member_id" = "direct_voter"."member_id";
+      UPDATE "direct_voter" SET "ownweight" = "issue_privilege"."weight"
+        FROM "issue_privilege"
+        WHERE "direct_voter"."issue_id" = "issue_id_p"
+        AND "issue_privilege"."issue_id" = "issue_id_p"
+        AND "issue_privilege"."member_id" = "direct_voter"."member_id";
+      PERFORM "add_vote_delegations"("issue_id_p");
+      -- mark first preferences:
+      -- (the highest grade of each voter is taken from the packed ballot)
+      UPDATE "vote" SET "first_preference" =
+        CASE WHEN "vote"."grade" > 0 THEN
+          CASE WHEN "vote"."grade" = "subquery"."max_grade" THEN TRUE ELSE FALSE END
+        ELSE NULL
+        END
+        FROM (
+          SELECT
+            "member_id",
+            ( SELECT max("grade") FROM unnest("ballot_grades") AS "grade" )
+            AS "max_grade"
+          FROM "direct_voter" WHERE "issue_id" = "issue_id_p"
+        ) AS "subquery"
+        WHERE "vote"."issue_id" = "issue_id_p"
+        AND "vote"."member_id" = "subquery"."member_id";
+      -- finish overriding protection triggers (avoids garbage):
+      DELETE FROM "temporary_transaction_data"
+        WHERE "key" = 'override_protection_triggers';
+      -- materialize battle_view:
+      -- NOTE: "closed" column of issue must be set at this point
+      DELETE FROM "battle" WHERE "issue_id" = "issue_id_p";
+      INSERT INTO "battle" (
+        "issue_id",
+        "winning_initiative_id", "losing_initiative_id",
+        "count"
+      ) SELECT
+        "issue_id",
+        "winning_initiative_id", "losing_initiative_id",
+        "count"
+        FROM "battle_view" WHERE "issue_id" = "issue_id_p";
+      -- set voter count:
+      UPDATE "issue" SET
+        "voter_count" = (
+          SELECT coalesce(sum("weight"), 0)
+          FROM "direct_voter" WHERE "issue_id" = "issue_id_p"
+        )
+        WHERE "id" = "issue_id_p";
+      -- copy "positive_votes" and "negative_votes" from "battle" table:
+      -- NOTE: "first_preference_votes" is set to a default of 0 at this step
+      UPDATE "initiative" SET
+        "first_preference_votes" = 0,
+        "positive_votes" = "battle_win"."count",
+        "negative_votes" = "battle_lose"."count"
+        FROM "battle" AS "battle_win", "battle" AS "battle_lose"
+        WHERE
+          "battle_win"."issue_id" = "issue_id_p" AND
+          "battle_win"."winning_initiative_id" = "initiative"."id" AND
+          "battle_win"."losing_initiative_id" ISNULL AND
+          "battle_lose"."issue_id" = "issue_id_p" AND
+          "battle_lose"."losing_initiative_id" = "initiative"."id" AND
+          "battle_lose"."winning_initiative_id" ISNULL;
+      -- calculate "first_preference_votes":
+      -- NOTE: will only set values not equal to zero
+      UPDATE "initiative" SET "first_preference_votes" = "subquery"."sum"
+        FROM (
+          SELECT "ballot"."initiative_id", sum("direct_voter"."weight")
+          FROM "direct_voter",
+          unnest("direct_voter"."ballot_initiative_ids", "direct_voter"."ballot_grades")
+          AS "ballot" ("initiative_id", "grade")
+          WHERE "direct_voter"."issue_id" = "issue_id_p"
+          AND "ballot"."grade" > 0
+          AND "ballot"."grade" = (
+            SELECT max("grade") FROM unnest("direct_voter"."ballot_grades") AS "grade"
+          )
+          GROUP BY "ballot"."initiative_id"
+        ) AS "subquery"
+        WHERE "initiative"."issue_id" = "issue_id_p"
+        AND "initiative"."admitted"
+        AND "initiative"."id" = "subquery"."initiative_id";
+    END;
+  $$;
+
+COMMENT ON FUNCTION "close_voting"
+  ( "issue"."id"%TYPE )
+  IS 'Closes the voting on an issue, and calculates positive and negative votes for each initiative; The ranking is not calculated yet, to keep the (locking) transaction short.';
+
+ALTER TABLE "snapshot" ADD COLUMN "txid_snapshot" TXID_SNAPSHOT;
+
+COMMENT ON COLUMN "snapshot"."calculated"    IS 'Point in time when the snapshot has been taken or, for snapshots of an area, last been confirmed by function "take_snapshot" to be still up to date';
+COMMENT ON COLUMN "snapshot"."txid_snapshot" IS 'Value of txid_current_snapshot() when the snapshot has been taken, used to determine whether any change logged in table "area_change" has not been visible yet; NULL for snapshots of a single issue';
+
+CREATE TABLE "area_change" (
+        "id"                    SERIAL8         PRIMARY KEY,
+        "xid"                   INT8            NOT NULL DEFAULT txid_current(),
+        "unit_id"               INT4,
+        "area_id"               INT4,
+        CONSTRAINT "unit_or_area" CHECK (("unit_id" NOTNULL) != ("area_id" NOTNULL)) );
+CREATE UNIQUE INDEX "area_change_area_id_xid_idx" ON "area_change" ("area_id", "xid");
+CREATE UNIQUE INDEX "area_change_unit_id_xid_idx" ON "area_change" ("unit_id", "xid");
+
+COMMENT ON TABLE "area_change" IS 'Log of transactions which have changed data relevant for the snapshots of an area (see trigger function "log_area_change_trigger"); Rows are only inserted (at most one per area or unit and transaction), such that concurrent transactions never wait for each other; Rows which are visible in all snapshots that could be reused are deleted by "lf_update" (see view "obsolete_area_change")';
+
+COMMENT ON COLUMN "area_change"."xid"     IS 'Transaction ID of the change';
+COMMENT ON COLUMN "area_change"."unit_id" IS 'Unit, if all areas of the unit are affected; No foreign key, to avoid locking the unit (rows of deleted units are removed by garbage collection)';
+COMMENT ON COLUMN "area_change"."area_id" IS 'Affected area, or NULL if all areas of the unit are affected; No foreign key, to avoid locking the area (rows of deleted areas are removed by garbage collection)';
+
+CREATE FUNCTION "log_area_change_trigger"()
+  RETURNS TRIGGER
+  LANGUAGE 'plpgsql' VOLATILE AS $$
+    DECLARE
+      "area_ids_v"       INT4[] = '{}';
+      "unit_ids_v"       INT4[] = '{}';
+      "issue_ids_v"      INT4[] = '{}';
+      "initiative_ids_v" INT4[] = '{}';
+      "member_id_v"      "member"."id"%TYPE;
+    BEGIN
+      IF TG_RELID = 'member'::regclass THEN
+        IF OLD."active" = NEW."active" THEN
+          RETURN NULL;
+        END IF;
+        "member_id_v" := NEW."id";
+      ELSIF TG_RELID = 'policy'::regclass THEN
+        SELECT INTO "area_ids_v" coalesce(array_agg(DISTINCT "area_id"), '{}')
+          FROM "issue"
+          WHERE "policy_id" = NEW."id" AND "state" = 'admission';
+      ELSIF TG_RELID = 'privilege'::regclass THEN
+        IF TG_OP != 'INSERT' THEN
+          "unit_ids_v" := "unit_ids_v" || OLD."unit_id";
+        END IF;
+        IF TG_OP != 'DELETE' THEN
+          "unit_ids_v" := "unit_ids_v" || NEW."unit_id";
+        END IF;
+      ELSIF TG_RELID = 'issue'::regclass THEN
+        IF TG_OP != 'INSERT' THEN
+          "area_ids_v" := "area_ids_v" || OLD."area_id";
+        END IF;
+        IF TG_OP != 'DELETE' THEN
+          "area_ids_v" := "area_ids_v" || NEW."area_id";
+        END IF;
+      ELSIF
+        TG_RELID = 'draft'::regclass OR
+        TG_RELID = 'suggestion'::regclass OR
+        TG_RELID = 'opinion'::regclass
+      THEN
+        IF TG_OP != 'INSERT' THEN
+          "initiative_ids_v" := "initiative_ids_v" || OLD."initiative_id";
+        END IF;
+        IF TG_OP != 'DELETE' THEN
+          "initiative_ids_v" := "initiative_ids_v" || NEW."initiative_id";
+        END IF;
+      ELSE
+        -- tables "issue_privilege", "interest", "initiative", and "supporter":
+        IF TG_OP != 'INSERT' THEN
+          "issue_ids_v" := "issue_ids_v" || OLD."issue_id";
+        END IF;
+        IF TG_OP != 'DELETE' THEN
+          "issue_ids_v" := "issue_ids_v" || NEW."issue_id";
+        END IF;
+      END IF;
+      INSERT INTO "area_change" ("unit_id", "area_id")
+        SELECT NULL, unnest("area_ids_v")
+        UNION
+        SELECT unnest("unit_ids_v"), NULL
+        UNION
+        SELECT NULL, "area_id" FROM "issue"
+          WHERE "id" = ANY("issue_ids_v")
+        UNION
+        SELECT NULL, "issue"."area_id" FROM "initiative"
+          JOIN "issue" ON "issue"."id" = "initiative"."issue_id"
+          WHERE "initiative"."id" = ANY("initiative_ids_v")
+        UNION
+        SELECT "unit_id", NULL FROM "privilege"
+          WHERE "member_id" = "member_id_v"
+        UNION
+        SELECT NULL, "issue"."area_id" FROM "issue_privilege"
+          JOIN "issue" ON "issue"."id" = "issue_privilege"."issue_id"
+          WHERE "issue_privilege"."member_id" = "member_id_v"
+        ON CONFLICT DO NOTHING;
+      RETURN NULL;
+    END;
+  $$;
+
+CREATE TRIGGER "log_area_change"
+  AFTER UPDATE OF "active" ON "member" FOR EACH ROW EXECUTE PROCEDURE
+  "log_area_change_trigger"();
+
+CREATE TRIGGER "log_area_change"
+  AFTER UPDATE OF "initiative_quorum", "initiative_quorum_num", "initiative_quorum_den"
+  ON "policy" FOR EACH ROW EXECUTE PROCEDURE
+  "log_area_change_trigger"();
+
+CREATE TRIGGER "log_area_change"
+  AFTER INSERT OR UPDATE OF "unit_id", "member_id", "voting_right", "weight" OR DELETE
+  ON "privilege" FOR EACH ROW EXECUTE PROCEDURE
+  "log_area_change_trigger"();
+
+CREATE TRIGGER "log_area_change"
+  AFTER INSERT OR UPDATE OF "area_id", "policy_id", "state" OR DELETE
+  ON "issue" FOR EACH ROW EXECUTE PROCEDURE
+  "log_area_change_trigger"();
+
+CREATE TRIGGER "log_area_change"
+  AFTER INSERT OR UPDATE OR DELETE ON "issue_privilege" FOR EACH ROW EXECUTE PROCEDURE
+  "log_area_change_trigger"();
+
+CREATE TRIGGER "log_area_change"
+  AFTER INSERT OR UPDATE OF "issue_id" OR DELETE ON "initiative" FOR EACH ROW EXECUTE PROCEDURE
+  "log_area_change_trigger"();
+
+CREATE TRIGGER "log_area_change"
+  AFTER INSERT OR UPDATE OF "initiative_id" OR DELETE ON "draft" FOR EACH ROW EXECUTE PROCEDURE
+  "log_area_change_trigger"();
+
+CREATE TRIGGER "log_area_change"
+  AFTER INSERT OR UPDATE OF "initiative_id" OR DELETE ON "suggestion" FOR EACH ROW EXECUTE PROCEDURE
+  "log_area_change_trigger"();
+
+CREATE TRIGGER "log_area_change"
+  AFTER INSERT OR UPDATE OR DELETE ON "interest" FOR EACH ROW EXECUTE PROCEDURE
+  "log_area_change_trigger"();
+
+CREATE TRIGGER "log_area_change"
+  AFTER INSERT OR UPDATE OR DELETE ON "supporter" FOR EACH ROW EXECUTE PROCEDURE
+  "log_area_change_trigger"();
+
+CREATE TRIGGER "log_area_change"
+  AFTER INSERT OR UPDATE OR DELETE ON "opinion" FOR EACH ROW EXECUTE PROCEDURE
+  "log_area_change_trigger"();
+
+COMMENT ON FUNCTION "log_area_change_trigger"()                IS 'Implementation of triggers "log_area_change" on tables "member", "policy", "privilege", "issue", "issue_privilege", "initiative", "draft", "suggestion", "interest", "supporter", and "opinion"';
+COMMENT ON TRIGGER "log_area_change" ON "member"               IS 'Logs a change of all units where the member has a privilege and of all areas with issues where the member has an issue privilege, when the member is activated or deactivated';
+COMMENT ON TRIGGER "log_area_change" ON "policy"               IS 'Logs a change of all areas with issues in admission phase using the policy, when the initiative quorum is changed';
+COMMENT ON TRIGGER "log_area_change" ON "privilege"            IS 'Logs a change of the unit';
+COMMENT ON TRIGGER "log_area_change" ON "issue"                IS 'Logs a change of the area, when an issue is created, deleted, moved, or changes its policy or state (but not when only snapshot related columns are updated)';
+COMMENT ON TRIGGER "log_area_change" ON "issue_privilege"      IS 'Logs a change of the area of the issue';
+COMMENT ON TRIGGER "log_area_change" ON "initiative"           IS 'Logs a change of the area, when an initiative is created or deleted';
+COMMENT ON TRIGGER "log_area_change" ON "draft"                IS 'Logs a change of the area, when a draft is created or deleted';
+COMMENT ON TRIGGER "log_area_change" ON "suggestion"           IS 'Logs a change of the area, when a suggestion is created or deleted';
+COMMENT ON TRIGGER "log_area_change" ON "interest"             IS 'Logs a change of the area of the issue';
+COMMENT ON TRIGGER "log_area_change" ON "supporter"            IS 'Logs a change of the area of the issue';
+COMMENT ON TRIGGER "log_area_change" ON "opinion"              IS 'Logs a change of the area of the initiative';
+
+CREATE FUNCTION "log_delegation_area_change_trigger"()
+  RETURNS TRIGGER
+  LANGUAGE 'plpgsql' VOLATILE AS $$
+    BEGIN
+      IF TG_OP != 'INSERT' THEN
+        INSERT INTO "area_change" ("unit_id", "area_id")
+          SELECT DISTINCT
+            CASE WHEN "area_id" ISNULL THEN "unit_id" END, "area_id"
+          FROM "old_delegation"
+          ON CONFLICT DO NOTHING;
+      END IF;
+      IF TG_OP != 'DELETE' THEN
+        INSERT INTO "area_change" ("unit_id", "area_id")
+          SELECT DISTINCT
+            CASE WHEN "area_id" ISNULL THEN "unit_id" END, "area_id"
+          FROM "new_delegation"
+          ON CONFLICT DO NOTHING;
+      END IF;
+      RETURN NULL;
+    END;
+  $$;
+
+CREATE TRIGGER "log_area_change"
+  AFTER INSERT ON "effective_delegation"
+  REFERENCING NEW TABLE AS "new_delegation"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_delegation_area_change_trigger"();
+
+CREATE TRIGGER "log_area_change_on_update"
+  AFTER UPDATE ON "effective_delegation"
+  REFERENCING OLD TABLE AS "old_delegation" NEW TABLE AS "new_delegation"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_delegation_area_change_trigger"();
+
+CREATE TRIGGER "log_area_change_on_delete"
+  AFTER DELETE ON "effective_delegation"
+  REFERENCING OLD TABLE AS "old_delegation"
+  FOR EACH STATEMENT EXECUTE PROCEDURE
+  "log_delegation_area_change_trigger"();
+
+COMMENT ON FUNCTION "log_delegation_area_change_trigger"()                  IS 'Implementation of triggers "log_area_change", "log_area_change_on_update", and "log_area_change_on_delete" on table "effective_delegation"';
+COMMENT ON TRIGGER "log_area_change"           ON "effective_delegation" IS 'Logs a change of the areas (or units for unit-wide delegations) of all rows inserted by a statement';
+COMMENT ON TRIGGER "log_area_change_on_update" ON "effective_delegation" IS 'Logs a change of the areas (or units for unit-wide delegations) of all rows updated by a statement';
+COMMENT ON TRIGGER "log_area_change_on_delete" ON "effective_delegation" IS 'Logs a change of the areas (or units for unit-wide delegations) of all rows deleted by a statement';
+
+CREATE VIEW "obsolete_area_change" AS
+  SELECT * FROM "area_change"
+  WHERE "xid" < txid_snapshot_xmin(txid_current_snapshot())
+  AND NOT EXISTS (
+    SELECT NULL FROM "issue"
+    JOIN "area" ON "area"."id" = "issue"."area_id"
+    JOIN "snapshot" ON "snapshot"."id" = "issue"."latest_snapshot_id"
+    WHERE "issue"."state" = 'admission'
+    AND (
+      "area"."id" = "area_change"."area_id" OR
+      "area"."unit_id" = "area_change"."unit_id" )
+    AND NOT txid_visible_in_snapshot("area_change"."xid", "snapshot"."txid_snapshot") );
+
+CREATE RULE "delete" AS ON DELETE TO "obsolete_area_change" DO INSTEAD
+  DELETE FROM "area_change" WHERE "id" = OLD."id";
+
+COMMENT ON VIEW "obsolete_area_change" IS 'Entries of table "area_change" of finished transactions which are visible in the latest snapshots of all issues in admission phase of the area (or unit), such that they cannot prevent reusing a snapshot anymore, and which can be deleted (including entries of deleted areas and units)';
+COMMENT ON RULE "delete" ON "obsolete_area_change" IS 'Rule allowing DELETE on rows in "obsolete_area_change" view, i.e. DELETE FROM "obsolete_area_change"';
+
+CREATE OR REPLACE VIEW "garbage_collection_backlog" AS
+  SELECT
+    (SELECT count(1) FROM "expired_session") AS "expired_session_count",
+    (SELECT count(1) FROM "expired_token")   AS "expired_token_count",
+    (SELECT count(1) FROM "unused_snapshot") AS "unused_snapshot_count",
+    (SELECT count(1) FROM "expired_member_contingent_counter")
+      AS "expired_member_contingent_counter_count",
+    (SELECT count(1) FROM "expired_data_change") AS "expired_data_change_count",
+    (SELECT count(1) FROM "obsolete_area_change") AS "obsolete_area_change_count";
+
+COMMENT ON VIEW "garbage_collection_backlog" IS 'Number of rows which are waiting to be deleted by the garbage collection of "lf_update"; "lf_update" deletes these rows in batches with a limited budget per run, so non-zero values which persist over several runs indicate that the budget is too small';
+
+CREATE OR REPLACE FUNCTION "take_snapshot"
+  ( "issue_id_p" "issue"."id"%TYPE,
+    "area_id_p"  "area"."id"%TYPE = NULL )
+  RETURNS "snapshot"."id"%TYPE
+  LANGUAGE 'plpgsql' VOLATILE AS $$
+    DECLARE
+      "area_id_v"     "area"."id"%TYPE;
+      "unit_id_v"     "unit"."id"%TYPE;
+      "snapshot_id_v" "snapshot"."id"%TYPE;
+      "issue_id_v"    "issue"."id"%TYPE;
+      "member_id_v"   "member"."id"%TYPE;
+      "txid_snapshot_v" "snapshot"."txid_snapshot"%TYPE;
+    BEGIN
+      IF "issue_id_p" NOTNULL AND "area_id_p" NOTNULL THEN
+        RAISE EXCEPTION 'One of "issue_id_p" and "area_id_p" must be NULL';
+      END IF;
+      PERFORM "require_transaction_isolation"();
+      IF "issue_id_p" ISNULL THEN
+        "area_id_v" := "area_id_p";
+        SELECT "unit_id" INTO "unit_id_v" FROM "area" WHERE "id" = "area_id_v";
+        -- reuse the latest snapshot of the area, if it has been finished for
+        -- all issues in admission phase and no change of the area or its
+        -- unit has been logged since (see triggers "log_area_change"):
+        SELECT "snapshot"."id", "snapshot"."txid_snapshot"
+          INTO "snapshot_id_v", "txid_snapshot_v"
+          FROM "issue" JOIN "snapshot"
+          ON "snapshot"."id" = "issue"."latest_snapshot_id"
+          WHERE "issue"."area_id" = "area_id_p"
+          AND "issue"."state" = 'admission'
+          AND "snapshot"."issue_id" ISNULL
+          AND "snapshot"."txid_snapshot" NOTNULL
+          LIMIT 1;
+        IF "snapshot_id_v" NOTNULL AND NOT EXISTS (
+          SELECT NULL FROM "issue"
+          WHERE "area_id" = "area_id_p"
+          AND "state" = 'admission'
+          AND "latest_snapshot_id" IS DISTINCT FROM "snapshot_id_v"
+        ) AND NOT EXISTS (
+          SELECT NULL FROM "area_change"
+          WHERE ("area_id" = "area_id_p" OR "unit_id" = "unit_id_v")
+          AND "xid" >= txid_snapshot_xmin("txid_snapshot_v")
+          AND NOT txid_visible_in_snapshot("xid", "txid_snapshot_v")
+        ) THEN
+          UPDATE "snapshot" SET "calculated" = now()
+            WHERE "id" = "snapshot_id_v";
+          UPDATE "issue" SET "calculated" = now()
+            WHERE "latest_snapshot_id" = "snapshot_id_v";
+          RETURN NULL;
+        END IF;
+      ELSE
+        SELECT "area_id" INTO "area_id_v"
+          FROM "issue" WHERE "id" = "issue_id_p";
+        SELECT "unit_id" INTO "unit_id_v" FROM "area" WHERE "id" = "area_id_v";
+      END IF;
+      INSERT INTO "snapshot" ("area_id", "issue_id", "txid_snapshot")
+        VALUES (
+          "area_id_v", "issue_id_p",
+          CASE WHEN "issue_id_p" ISNULL THEN txid_current_snapshot() END )
+        RETURNING "id" INTO "snapshot_id_v";
+      INSERT INTO "snapshot_population" ("snapshot_id", "member_id", "weight")
+        SELECT
+          "snapshot_id_v",
+          "member"."id",
+          COALESCE("issue_privilege"."weight", "privilege"."weight")
+        FROM "member"
+        LEFT JOIN "privilege"
+        ON "privilege"."unit_id" = "unit_id_v"
+        AND "privilege"."member_id" = "member"."id"
+        LEFT JOIN "issue_privilege"
+        ON "issue_privilege"."issue_id" = "issue_id_p"
+        AND "issue_privilege"."member_id" = "member"."id"
+        WHERE "member"."active" AND COALESCE(
+          "issue_privilege"."voting_right", "privilege"."voting_right");
+      UPDATE "snapshot" SET
+        "population" = (
+          SELECT sum("weight") FROM "snapshot_population"
+          WHERE "snapshot_id" = "snapshot_id_v"
+        ) WHERE "id" = "snapshot_id_v";
+      FOR "issue_id_v" IN
+        SELECT "id" FROM "issue"
+        WHERE CASE WHEN "issue_id_p" ISNULL THEN
+          "area_id" = "area_id_p" AND
+          "state" = 'admission'
+        ELSE
+          "id" = "issue_id_p"
+        END
+      LOOP
+        INSERT INTO "snapshot_issue" ("snapshot_id", "issue_id")
+          VALUES ("snapshot_id_v", "issue_id_v");
+        INSERT INTO "direct_interest_snapshot"
+          ("snapshot_id", "issue_id", "member_id", "ownweight")
+          SELECT
+            "snapshot_id_v" AS "snapshot_id",
+            "issue_id_v"    AS "issue_id",
+            "member"."id"   AS "member_id",
+            COALESCE(
+              "issue_privilege"."weight", "privilege"."weight"
+            ) AS "ownweight"
+          FROM "issue"
+          JOIN "area" ON "issue"."area_id" = "area"."id"
+          JOIN "interest" ON "issue"."id" = "interest"."issue_id"
+          JOIN "member" ON "interest"."member_id" = "member"."id"
+          LEFT JOIN "privilege"
+            ON "privilege"."unit_id" = "area"."unit_id"
+            AND "privilege"."member_id" = "member"."id"
+          LEFT JOIN "issue_privilege"
+            ON "issue_privilege"."issue_id" = "issue_id_v"
+            AND "issue_privilege"."member_id" = "member"."id"
+          WHERE "issue"."id" = "issue_id_v"
+          AND "member"."active" AND COALESCE(
+            "issue_privilege"."voting_right", "privilege"."voting_right");
+        FOR "member_id_v" IN
+          SELECT "member_id" FROM "direct_interest_snapshot"
+          WHERE "snapshot_id" = "snapshot_id_v"
+          AND "issue_id" = "issue_id_v"
+        LOOP
+          UPDATE "direct_interest_snapshot" SET
+            "weight" = "ownweight" +
+              "weight_of_added_delegations_for_snapshot"(
+                "snapshot_id_v",
+                "issue_id_v",
+                "member_id_v",
+                '{}'
+              )
+            WHERE "snapshot_id" = "snapshot_id_v"
+            AND "issue_id" = "issue_id_v"
+            AND "member_id" = "member_id_v";
+        END LOOP;
+        INSERT INTO "direct_supporter_snapshot"
+          ( "snapshot_id", "issue_id", "initiative_id", "member_id",
+            "draft_id", "informed", "satisfied" )
+          SELECT
+            "snapshot_id_v"         AS "snapshot_id",
+            "issue_id_v"            AS "issue_id",
+            "initiative"."id"       AS "initiative_id",
+            "supporter"."member_id" AS "member_id",
+            "supporter"."draft_id"  AS "draft_id",
+            "supporter"."draft_id" = "current_draft"."id" AS "informed",
+            NOT EXISTS (
+              SELECT NULL FROM "critical_opinion"
+              WHERE "initiative_id" = "initiative"."id"
+              AND "member_id" = "supporter"."member_id"
+            ) AS "satisfied"
+          FROM "initiative"
+          JOIN "supporter"
+          ON "supporter"."initiative_id" = "initiative"."id"
+          JOIN "current_draft"
+          ON "initiative"."id" = "current_draft"."initiative_id"
+          JOIN "direct_interest_snapshot"
+          ON "snapshot_id_v" = "direct_interest_snapshot"."snapshot_id"
+          AND "supporter"."member_id" = "direct_interest_snapshot"."member_id"
+          AND "initiative"."issue_id" = "direct_interest_snapshot"."issue_id"
+          WHERE "initiative"."issue_id" = "issue_id_v";
+        DELETE FROM "temporary_suggestion_counts" WHERE "id" IN (
+          SELECT "suggestion"."id" FROM "suggestion" JOIN "initiative"
+          ON "suggestion"."initiative_id" = "initiative"."id"
+          WHERE "initiative"."issue_id" = "issue_id_v" );
+        INSERT INTO "temporary_suggestion_counts"
+          ( "id",
+            "minus2_unfulfilled_count", "minus2_fulfilled_count",
+            "minus1_unfulfilled_count", "minus1_fulfilled_count",
+            "plus1_unfulfilled_count", "plus1_fulfilled_count",
+            "plus2_unfulfilled_count", "plus2_fulfilled_count" )
+          SELECT
+            "suggestion"."id",
+            ( SELECT coalesce(sum("di"."weight"), 0)
+              FROM "opinion" JOIN "direct_interest_snapshot" AS "di"
+              ON "di"."snapshot_id" = "snapshot_id_v"
+              AND "di"."issue_id" = "issue_id_v"
+              AND "di"."member_id" = "opinion"."member_id"
+              WHERE "opinion"."suggestion_id" = "suggestion"."id"
+              AND "opinion"."degree" = -2
+              AND "opinion"."fulfilled" = FALSE
+            ) AS "minus2_unfulfilled_count",
+            ( SELECT coalesce(sum("di"."weight"), 0)
+              FROM "opinion" JOIN "direct_interest_snapshot" AS "di"
+              ON "di"."snapshot_id" = "snapshot_id_v"
+              AND "di"."issue_id" = "issue_id_v"
+              AND "di"."member_id" = "opinion"."member_id"
+              WHERE "opinion"."suggestion_id" = "suggestion"."id"
+              AND "opinion"."degree" = -2
+              AND "opinion"."fulfilled" = TRUE
+            ) AS "minus2_fulfilled_count",
+            ( SELECT coalesce(sum("di"."weight"), 0)
+              FROM "opinion" JOIN "direct_interest_snapshot" AS "di"
+              ON "di"."snapshot_id" = "snapshot_id_v"
+              AND "di"."issue_id" = "issue_id_v"
+              AND "di"."member_id" = "opinion"."member_id"
+              WHERE "opinion"."suggestion_id" = "suggestion"."id"
+              AND "opinion"."degree" = -1
+              AND "opinion"."fulfilled" = FALSE
+            ) AS "minus1_unfulfilled_count",
+            ( SELECT coalesce(sum("di"."weight"), 0)
+              FROM "opinion" JOIN "direct_interest_snapshot" AS "di"
+              ON "di"."snapshot_id" = "snapshot_id_v"
+              AND "di"."issue_id" = "issue_id_v"
+              AND "di"."member_id" = "opinion"."member_id"
+              WHERE "opinion"."suggestion_id" = "suggestion"."id"
+              AND "opinion"."degree" = -1
+              AND "opinion"."fulfilled" = TRUE
+            ) AS "minus1_fulfilled_count",
+            ( SELECT coalesce(sum("di"."weight"), 0)
+              FROM "opinion" JOIN "direct_interest_snapshot" AS "di"
+              ON "di"."snapshot_id" = "snapshot_id_v"
+              AND "di"."issue_id" = "issue_id_v"
+              AND "di"."member_id" = "opinion"."member_id"
+              WHERE "opinion"."suggestion_id" = "suggestion"."id"
+              AND "opinion"."degree" = 1
+              AND "opinion"."fulfilled" = FALSE
+            ) AS "plus1_unfulfilled_count",
+            ( SELECT coalesce(sum("di"."weight"), 0)
+              FROM "opinion" JOIN "direct_interest_snapshot" AS "di"
+              ON "di"."snapshot_id" = "snapshot_id_v"
+              AND "di"."issue_id" = "issue_id_v"
+              AND "di"."member_id" = "opinion"."member_id"
+              WHERE "opinion"."suggestion_id" = "suggestion"."id"
+              AND "opinion"."degree" = 1
+              AND "opinion"."fulfilled" = TRUE
+            ) AS "plus1_fulfilled_count",
+            ( SELECT coalesce(sum("di"."weight"), 0)
+              FROM "opinion" JOIN "direct_interest_snapshot" AS "di"
+              ON "di"."snapshot_id" = "snapshot_id_v"
+              AND "di"."issue_id" = "issue_id_v"
+              AND "di"."member_id" = "opinion"."member_id"
+              WHERE "opinion"."suggestion_id" = "suggestion"."id"
+              AND "opinion"."degree" = 2
+              AND "opinion"."fulfilled" = FALSE
+            ) AS "plus2_unfulfilled_count",
+            ( SELECT coalesce(sum("di"."weight"), 0)
+              FROM "opinion" JOIN "direct_interest_snapshot" AS "di"
+              ON "di"."snapshot_id" = "snapshot_id_v"
+              AND "di"."issue_id" = "issue_id_v"
+              AND "di"."member_id" = "opinion"."member_id"
+              WHERE "opinion"."suggestion_id" = "suggestion"."id"
+              AND "opinion"."degree" = 2
+              AND "opinion"."fulfilled" = TRUE
+            ) AS "plus2_fulfilled_count"
+            FROM "suggestion" JOIN "initiative"
+            ON "suggestion"."initiative_id" = "initiative"."id"
+            WHERE "initiative"."issue_id" = "issue_id_v";
+      END LOOP;
+      RETURN "snapshot_id_v";
+    END;
+  $$;
+
+COMMENT ON FUNCTION "take_snapshot"
+  ( "issue"."id"%TYPE,
+    "area"."id"%TYPE )
+  IS 'This function creates a new interest/supporter snapshot of a particular issue, or, if the first argument is NULL, for all issues in ''admission'' phase of the area given as second argument. It must be executed with TRANSACTION ISOLATION LEVEL REPEATABLE READ. The snapshot must later be finished by calling "finish_snapshot" for every issue. If the latest snapshot of the area is still up to date (i.e. no change has been logged in table "area_change" which has not been visible when the snapshot has been taken), then no new snapshot is created, the "calculated" timestamps of the existing snapshot and its issues are updated, and NULL is returned (nothing needs to be finished in that case).';
+
+CREATE OR REPLACE VIEW "unused_snapshot" AS
+  SELECT * FROM "snapshot"
+  WHERE NOT EXISTS (
+    SELECT NULL FROM "issue"
+    WHERE "issue"."latest_snapshot_id" = "snapshot"."id" )
+  AND NOT EXISTS (
+    SELECT NULL FROM "issue"
+    WHERE "issue"."admission_snapshot_id" = "snapshot"."id" )
+  AND NOT EXISTS (
+    SELECT NULL FROM "issue"
+    WHERE "issue"."half_freeze_snapshot_id" = "snapshot"."id" )
+  AND NOT EXISTS (
+    SELECT NULL FROM "issue"
+    WHERE "issue"."full_freeze_snapshot_id" = "snapshot"."id" )
+  AND NOT EXISTS (
+    SELECT NULL FROM "snapshot_issue" JOIN "issue"
+    ON "issue"."id" = "snapshot_issue"."issue_id"
+    WHERE "snapshot_issue"."snapshot_id" = "snapshot"."id"
+    AND "issue"."closed" ISNULL
+    AND coalesce("issue"."latest_snapshot_id" < "snapshot"."id", TRUE) );
+
+COMMENT ON VIEW "unused_snapshot" IS 'Snapshots that are not referenced by any issue (either as latest snapshot or as snapshot at phase/state change), except for snapshots which have been taken but not been finished yet for an open issue (see function "finish_snapshot")';
+
+DROP FUNCTION "finish_snapshot"("issue"."id"%TYPE);
+
+CREATE FUNCTION "finish_snapshot"
+  ( "issue_id_p"    "issue"."id"%TYPE,
+    "snapshot_id_p" "snapshot"."id"%TYPE )
+  RETURNS VOID
+  LANGUAGE 'plpgsql' VOLATILE AS $$
+    BEGIN
+      -- NOTE: function does not require snapshot isolation but we don't call
+      --       "dont_require_snapshot_isolation" here because this function is
+      --       also invoked by "check_issue"
+      LOCK TABLE "snapshot" IN EXCLUSIVE MODE;
+      UPDATE "issue" SET
+        "calculated" = "snapshot"."calculated",
+        "latest_snapshot_id" = "snapshot_id_p",
+        "population" = "snapshot"."population",
+        "initiative_quorum" = CASE WHEN
+          "policy"."initiative_quorum" > ceil(
+            ( "issue"."population"::INT8 *
+              "policy"."initiative_quorum_num"::INT8 ) /
+            "policy"."initiative_quorum_den"::FLOAT8
+          )::INT4
+        THEN
+          "policy"."initiative_quorum"
+        ELSE
+          ceil(
+            ( "issue"."population"::INT8 *
+              "policy"."initiative_quorum_num"::INT8 ) /
+            "policy"."initiative_quorum_den"::FLOAT8
+          )::INT4
+        END
+        FROM "snapshot", "policy"
+        WHERE "issue"."id" = "issue_id_p"
+        AND "snapshot"."id" = "snapshot_id_p"
+        AND "policy"."id" = "issue"."policy_id";
+      UPDATE "initiative" SET
+        "supporter_count" = (
+          SELECT coalesce(sum("di"."weight"), 0)
+          FROM "direct_interest_snapshot" AS "di"
+          JOIN "direct_supporter_snapshot" AS "ds"
+          ON "di"."member_id" = "ds"."member_id"
+          WHERE "di"."snapshot_id" = "snapshot_id_p"
+          AND "di"."issue_id" = "issue_id_p"
+          AND "ds"."snapshot_id" = "snapshot_id_p"
+          AND "ds"."initiative_id" = "initiative"."id"
+        ),
+        "informed_supporter_count" = (
+          SELECT coalesce(sum("di"."weight"), 0)
+          FROM "direct_interest_snapshot" AS "di"
+          JOIN "direct_supporter_snapshot" AS "ds"
+          ON "di"."member_id" = "ds"."member_id"
+          WHERE "di"."snapshot_id" = "snapshot_id_p"
+          AND "di"."issue_id" = "issue_id_p"
+          AND "ds"."snapshot_id" = "snapshot_id_p"
+          AND "ds"."initiative_id" = "initiative"."id"
+          AND "ds"."informed"
+        ),
+        "satisfied_supporter_count" = (
+          SELECT coalesce(sum("di"."weight"), 0)
+          FROM "direct_interest_snapshot" AS "di"
+          JOIN "direct_supporter_snapshot" AS "ds"
+          ON "di"."member_id" = "ds"."member_id"
+          WHERE "di"."snapshot_id" = "snapshot_id_p"
+          AND "di"."issue_id" = "issue_id_p"
+          AND "ds"."snapshot_id" = "snapshot_id_p"
+          AND "ds"."initiative_id" = "initiative"."id"
+          AND "ds"."satisfied"
+        ),
+        "satisfied_informed_supporter_count" = (
+          SELECT coalesce(sum("di"."weight"), 0)
+          FROM "direct_interest_snapshot" AS "di"
+          JOIN "direct_supporter_snapshot" AS "ds"
+          ON "di"."member_id" = "ds"."member_id"
+          WHERE "di"."snapshot_id" = "snapshot_id_p"
+          AND "di"."issue_id" = "issue_id_p"
+          AND "ds"."snapshot_id" = "snapshot_id_p"
+          AND "ds"."initiative_id" = "initiative"."id"
+          AND "ds"."informed"
+          AND "ds"."satisfied"
+        )
+        WHERE "issue_id" = "issue_id_p";
+      UPDATE "suggestion" SET
+        "minus2_unfulfilled_count" = "temp"."minus2_unfulfilled_count",
+        "minus2_fulfilled_count"   = "temp"."minus2_fulfilled_count",
+        "minus1_unfulfilled_count" = "temp"."minus1_unfulfilled_count",
+        "minus1_fulfilled_count"   = "temp"."minus1_fulfilled_count",
+        "plus1_unfulfilled_count"  = "temp"."plus1_unfulfilled_count",
+        "plus1_fulfilled_count"    = "temp"."plus1_fulfilled_count",
+        "plus2_unfulfilled_count"  = "temp"."plus2_unfulfilled_count",
+        "plus2_fulfilled_count"    = "temp"."plus2_fulfilled_count"
+        FROM "temporary_suggestion_counts" AS "temp", "initiative"
+        WHERE "temp"."id" = "suggestion"."id"
+        AND "initiative"."issue_id" = "issue_id_p"
+        AND "suggestion"."initiative_id" = "initiative"."id";
+      DELETE FROM "temporary_suggestion_counts" WHERE "id" IN (
+        SELECT "suggestion"."id" FROM "suggestion" JOIN "initiative"
+        ON "suggestion"."initiative_id" = "initiative"."id"
+        WHERE "initiative"."issue_id" = "issue_id_p" );
+      RETURN;
+    END;
+  $$;
+
+COMMENT ON FUNCTION "finish_snapshot"
+  ( "issue"."id"%TYPE,
+    "snapshot"."id"%TYPE )
+  IS 'After calling "take_snapshot", this function "finish_snapshot" needs to be called for every issue in the snapshot, with the id of the snapshot returned by "take_snapshot" as second argument (separate function calls keep locking time minimal)';
+
+CREATE OR REPLACE FUNCTION "check_issue"
+  ( "issue_id_p" "issue"."id"%TYPE,
+    "persist"    "check_issue_persistence" )
+  RETURNS "check_issue_persistence"
+  LANGUAGE 'plpgsql' VOLATILE AS $$
+    DECLARE
+      "issue_row"         "issue"%ROWTYPE;
+      "last_calculated_v" "snapshot"."calculated"%TYPE;
+      "policy_row"        "policy"%ROWTYPE;
+      "initiative_row"    "initiative"%ROWTYPE;
+      "state_v"           "issue_state";
+    BEGIN
+      PERFORM "require_transaction_isolation"();
+      IF "persist" ISNULL THEN
+        SELECT * INTO "issue_row" FROM "issue" WHERE "id" = "issue_id_p"
+          FOR UPDATE;
+        SELECT "calculated" INTO "last_calculated_v"
+          FROM "snapshot" JOIN "snapshot_issue"
+          ON "snapshot"."id" = "snapshot_issue"."snapshot_id"
+          WHERE "snapshot_issue"."issue_id" = "issue_id_p"
+          ORDER BY "snapshot"."id" DESC;
+        IF "issue_row"."closed" NOTNULL THEN
+          RETURN NULL;
+        END IF;
+        "persist"."state" := "issue_row"."state";
+        IF
+          ( "issue_row"."state" = 'admission' AND "last_calculated_v" >=
+            "issue_row"."created" + "issue_row"."max_admission_time" ) OR
+          ( "issue_row"."state" = 'discussion' AND now() >=
+            "issue_row"."accepted" + "issue_row"."discussion_time" ) OR
+          ( "issue_row"."state" = 'verification' AND now() >=
+            "issue_row"."half_frozen" + "issue_row"."verification_time" ) OR
+          ( "issue_row"."state" = 'voting' AND now() >=
+            "issue_row"."fully_frozen" + "issue_row"."voting_time" )
+        THEN
+          "persist"."phase_finished" := TRUE;
+        ELSE
+          "persist"."phase_finished" := FALSE;
+        END IF;
+        IF
+          NOT EXISTS (
+            -- all initiatives are revoked
+            SELECT NULL FROM "initiative"
+            WHERE "issue_id" = "issue_id_p" AND "revoked" ISNULL
+          ) AND (
+            -- and issue has not been accepted yet
+            "persist"."state" = 'admission' OR
+            -- or verification time has elapsed
+            ( "persist"."state" = 'verification' AND
+              "persist"."phase_finished" ) OR
+            -- or no initiatives have been revoked lately
+            NOT EXISTS (
+              SELECT NULL FROM "initiative"
+              WHERE "issue_id" = "issue_id_p"
+              AND now() < "revoked" + "issue_row"."verification_time"
+            )
+          )
+        THEN
+          "persist"."issue_revoked" := TRUE;
+        ELSE
+          "persist"."issue_revoked" := FALSE;
+        END IF;
+        IF "persist"."phase_finished" OR "persist"."issue_revoked" THEN
+          UPDATE "issue" SET "phase_finished" = now()
+            WHERE "id" = "issue_row"."id";
+          RETURN "persist";
+        ELSIF
+          "persist"."state" IN ('admission', 'discussion', 'verification')
+        THEN
+          RETURN "persist";
+        ELSE
+          RETURN NULL;
+        END IF;
+      END IF;
+      IF
+        "persist"."state" IN ('admission', 'discussion', 'verification') AND
+        coalesce("persist"."snapshot_created", FALSE) = FALSE
+      THEN
+        IF "persist"."state" != 'admission' THEN
+          PERFORM "finish_snapshot"("issue_id_p", "take_snapshot"("issue_id_p"));
+        ELSE
+          UPDATE "issue" SET "issue_quorum" = "issue_quorum"."issue_quorum"
+            FROM "issue_quorum"
+            WHERE "id" = "issue_id_p"
+            AND "issue_quorum"."issue_id" = "issue_id_p";
+        END IF;
+        "persist"."snapshot_created" = TRUE;
+        IF "persist"."phase_finished" THEN
+          IF "persist"."state" = 'admission' THEN
+            UPDATE "issue" SET "admission_snapshot_id" = "latest_snapshot_id"
+              WHERE "id" = "issue_id_p";
+          ELSIF "persist"."state" = 'discussion' THEN
+            UPDATE "issue" SET "half_freeze_snapshot_id" = "latest_snapshot_id"
+              WHERE "id" = "issue_id_p";
+          ELSIF "persist"."state" = 'verification' THEN
+            UPDATE "issue" SET "full_freeze_snapshot_id" = "latest_snapshot_id"
+              WHERE "id" = "issue_id_p";
+            SELECT * INTO "issue_row" FROM "issue" WHERE "id" = "issue_id_p";
+            FOR "initiative_row" IN
+              SELECT * FROM "initiative"
+              WHERE "issue_id" = "issue_id_p" AND "revoked" ISNULL
+              FOR UPDATE
+            LOOP
+              IF
+                "initiative_row"."polling" OR
+                "initiative_row"."satisfied_supporter_count" >=
+                "issue_row"."initiative_quorum"
+              THEN
+                UPDATE "initiative" SET "admitted" = TRUE
+                  WHERE "id" = "initiative_row"."id";
+              ELSE
+                UPDATE "initiative" SET "admitted" = FALSE
+                  WHERE "id" = "initiative_row"."id";
+              END IF;
+            END LOOP;
+          END IF;
+        END IF;
+        RETURN "persist";
+      END IF;
+      IF
+        "persist"."state" IN ('admission', 'discussion', 'verification') AND
+        coalesce("persist"."harmonic_weights_set", FALSE) = FALSE
+      THEN
+        PERFORM "set_harmonic_initiative_weights"("issue_id_p");
+        "persist"."harmonic_weights_set" = TRUE;
+        IF
+          "persist"."phase_finished" OR
+          "persist"."issue_revoked" OR
+          "persist"."state" = 'admission'
+        THEN
+          RETURN "persist";
+        ELSE
+          RETURN NULL;
+        END IF;
+      END IF;
+      IF "persist"."issue_revoked" THEN
+        IF "persist"."state" = 'admission' THEN
+          "state_v" := 'canceled_revoked_before_accepted';
+        ELSIF "persist"."state" = 'discussion' THEN
+          "state_v" := 'canceled_after_revocation_during_discussion';
+        ELSIF "persist"."state" = 'verification' THEN
+          "state_v" := 'canceled_after_revocation_during_verification';
+        END IF;
+        UPDATE "issue" SET
+          "state"          = "state_v",
+          "closed"         = "phase_finished",
+          "phase_finished" = NULL
+          WHERE "id" = "issue_id_p";
+        RETURN NULL;
+      END IF;
+      IF "persist"."state" = 'admission' THEN
+        SELECT * INTO "issue_row" FROM "issue" WHERE "id" = "issue_id_p"
+          FOR UPDATE;
+        IF "issue_row"."phase_finished" NOTNULL THEN
+          UPDATE "issue" SET
+            "state"          = 'canceled_issue_not_accepted',
+            "closed"         = "phase_finished",
+            "phase_finished" = NULL
+            WHERE "id" = "issue_id_p";
+        END IF;
+        RETURN NULL;
+      END IF;
+      IF "persist"."phase_finished" THEN
+        IF "persist"."state" = 'discussion' THEN
+          UPDATE "issue" SET
+            "state"          = 'verification',
+            "half_frozen"    = "phase_finished",
+            "phase_finished" = NULL
+            WHERE "id" = "issue_id_p";
+          RETURN NULL;
+        END IF;
+        IF "persist"."state" = 'verification' THEN
+          SELECT * INTO "issue_row" FROM "issue" WHERE "id" = "issue_id_p"
+            FOR UPDATE;
+          SELECT * INTO "policy_row" FROM "policy"
+            WHERE "id" = "issue_row"."policy_id";
+          IF EXISTS (
+            SELECT NULL FROM "initiative"
+            WHERE "issue_id" = "issue_id_p" AND "admitted" = TRUE
+          ) THEN
+            UPDATE "issue" SET
+              "state"          = 'voting',
+              "fully_frozen"   = "phase_finished",
+              "phase_finished" = NULL
+              WHERE "id" = "issue_id_p";
+          ELSE
+            UPDATE "issue" SET
+              "state"          = 'canceled_no_initiative_admitted',
+              "fully_frozen"   = "phase_finished",
+              "closed"         = "phase_finished",
+              "phase_finished" = NULL
+              WHERE "id" = "issue_id_p";
+            -- NOTE: The following DELETE statements have effect only when
+            --       issue state has been manipulated
+            DELETE FROM "direct_voter"     WHERE "issue_id" = "issue_id_p";
+            DELETE FROM "delegating_voter" WHERE "issue_id" = "issue_id_p";
+            DELETE FROM "battle"           WHERE "issue_id" = "issue_id_p";
+          END IF;
+          RETURN NULL;
+        END IF;
+        IF "persist"."state" = 'voting' THEN
+          IF coalesce("persist"."closed_voting", FALSE) = FALSE THEN
+            PERFORM "close_voting"("issue_id_p");
+            "persist"."closed_voting" = TRUE;
+            RETURN "persist";
+          END IF;
+          PERFORM "calculate_ranks"("issue_id_p");
+          RETURN NULL;
+        END IF;
+      END IF;
+      RAISE WARNING 'should not happen';
+      RETURN NULL;
+    END;
+  $$;
+
+CREATE OR REPLACE FUNCTION "check_everything"()
+  RETURNS VOID
+  LANGUAGE 'plpgsql' VOLATILE AS $$
+    DECLARE
+      "area_id_v"     "area"."id"%TYPE;
+      "snapshot_id_v" "snapshot"."id"%TYPE;
+      "issue_id_v"    "issue"."id"%TYPE;
+      "persist_v"     "check_issue_persistence";
+    BEGIN
+      RAISE WARNING 'Function "check_everything" should only be used for development and debugging purposes';
+      DELETE FROM "expired_session";
+      DELETE FROM "expired_token";
+      DELETE FROM "unused_snapshot";
+      DELETE FROM "expired_member_contingent_counter";
+      DELETE FROM "expired_data_change";
+      PERFORM "create_event_partitions"();
+      PERFORM "check_activity"();
+      PERFORM "calculate_member_counts"();
+      FOR "area_id_v" IN SELECT "id" FROM "area_with_unaccepted_issues" LOOP
+        SELECT "take_snapshot"(NULL, "area_id_v") INTO "snapshot_id_v";
+        PERFORM "finish_snapshot"("issue_id", "snapshot_id_v")
+          FROM "snapshot_issue" WHERE "snapshot_id" = "snapshot_id_v";
+        LOOP
+          EXIT WHEN "issue_admission"("area_id_v") = FALSE;
+        END LOOP;
+      END LOOP;
+      FOR "issue_id_v" IN SELECT "id" FROM "open_issue" LOOP
+        "persist_v" := NULL;
+        LOOP
+          "persist_v" := "check_issue"("issue_id_v", "persist_v");
+          EXIT WHEN "persist_v" ISNULL;
+        END LOOP;
+      END LOOP;
+      DELETE FROM "unused_snapshot";
+      DELETE FROM "expired_member_contingent_counter";
+      RETURN;
+    END;
+  $$;
+
+COMMIT;
@@ -0,0 +1,6 @@
+-- delegate in an area, or remove the delegation (with a probability of 10%):
+\set truster random(1, :members)
+\set trustee random_zipfian(1, :members, 1.1)
+\set remove random(1, 10)
+\set area random(1, :areas)
+SELECT "workload"."delegate"(:truster, CASE WHEN :remove > 1 THEN :trustee END, :area);
@@ -0,0 +1,4 @@
+-- post a message in an area:
+\set member random(1, :members)
+\set area random(1, :areas)
+SELECT "workload"."post"(:member, :area);
@@ -0,0 +1,6 @@
+-- rate a suggestion (popular suggestions are chosen more often):
+\set member random(1, :members)
+\set suggestion random_zipfian(1, :suggestions, 1.1)
+\set degree random(1, 4)
+\set fulfilled random(0, 1)
+SELECT "workload"."rate"(:member, :suggestion, (ARRAY[-2, -1, 1, 2])[:degree], :fulfilled = 1);
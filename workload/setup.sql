@@ -0,0 +1,129 @@
+-- Functions simulating frontend actions for "lf_workload", which are
+-- called by the pgbench scripts in this directory. Each action runs in
+-- a single transaction with the default isolation level (like the
+-- frontend does), fires the usual triggers, and returns FALSE instead
+-- of failing if the action is not possible (anymore), e.g. because the
+-- issue has entered another phase in the meantime. Serialization
+-- failures and deadlocks are not caught, such that pgbench counts them.
+
+CREATE SCHEMA "workload";
+
+-- add or remove support for an initiative:
+CREATE FUNCTION "workload"."support"
+  ( "member_id_p"     "member"."id"%TYPE,
+    "initiative_id_p" "initiative"."id"%TYPE )
+  RETURNS BOOLEAN
+  LANGUAGE 'plpgsql' VOLATILE AS $$
+    BEGIN
+      DELETE FROM "supporter"
+        WHERE "initiative_id" = "initiative_id_p"
+        AND "member_id" = "member_id_p";
+      IF NOT FOUND THEN
+        INSERT INTO "supporter" ("initiative_id", "member_id")
+          SELECT "initiative"."id", "member_id_p"
+          FROM "initiative" JOIN "issue" ON "issue"."id" = "initiative"."issue_id"
+          WHERE "initiative"."id" = "initiative_id_p"
+          AND "initiative"."revoked" ISNULL
+          AND "issue"."state" IN ('admission', 'discussion', 'verification')
+          AND "issue"."phase_finished" ISNULL;
+      END IF;
+      RETURN FOUND;
+    EXCEPTION WHEN integrity_constraint_violation OR raise_exception THEN
+      RETURN FALSE;
+    END;
+  $$;
+
+-- rate a suggestion (implicitly supporting its initiative):
+CREATE FUNCTION "workload"."rate"
+  ( "member_id_p"     "member"."id"%TYPE,
+    "suggestion_id_p" "suggestion"."id"%TYPE,
+    "degree_p"        "opinion"."degree"%TYPE,
+    "fulfilled_p"     "opinion"."fulfilled"%TYPE )
+  RETURNS BOOLEAN
+  LANGUAGE 'plpgsql' VOLATILE AS $$
+    BEGIN
+      INSERT INTO "opinion" ("suggestion_id", "member_id", "degree", "fulfilled")
+        SELECT "suggestion"."id", "member_id_p", "degree_p", "fulfilled_p"
+        FROM "suggestion"
+        JOIN "initiative" ON "initiative"."id" = "suggestion"."initiative_id"
+        JOIN "issue" ON "issue"."id" = "initiative"."issue_id"
+        WHERE "suggestion"."id" = "suggestion_id_p"
+        AND "initiative"."revoked" ISNULL
+        AND "issue"."state" IN ('admission', 'discussion', 'verification')
+        AND "issue"."phase_finished" ISNULL
+        ON CONFLICT ("suggestion_id", "member_id") DO UPDATE SET
+          "degree"    = "excluded"."degree",
+          "fulfilled" = "excluded"."fulfilled";
+      RETURN FOUND;
+    EXCEPTION WHEN integrity_constraint_violation OR raise_exception THEN
+      RETURN FALSE;
+    END;
+  $$;
+
+-- delegate in an area to a trustee, or remove the delegation (if "trustee_id_p" is NULL):
+CREATE FUNCTION "workload"."delegate"
+  ( "truster_id_p" "member"."id"%TYPE,
+    "trustee_id_p" "member"."id"%TYPE,
+    "area_id_p"    "area"."id"%TYPE )
+  RETURNS BOOLEAN
+  LANGUAGE 'plpgsql' VOLATILE AS $$
+    BEGIN
+      IF "trustee_id_p" ISNULL THEN
+        DELETE FROM "delegation"
+          WHERE "area_id" = "area_id_p" AND "truster_id" = "truster_id_p";
+      ELSE
+        INSERT INTO "delegation" ("truster_id", "trustee_id", "scope", "area_id")
+          VALUES ("truster_id_p", "trustee_id_p", 'area', "area_id_p")
+          ON CONFLICT ("area_id", "truster_id") DO UPDATE SET
+            "trustee_id" = "excluded"."trustee_id";
+      END IF;
+      RETURN FOUND;
+    EXCEPTION WHEN integrity_constraint_violation OR raise_exception THEN
+      RETURN FALSE;
+    END;
+  $$;
+
+-- cast (or replace) a ballot with random grades for all admitted initiatives of an issue in voting:
+CREATE FUNCTION "workload"."vote"
+  ( "member_id_p" "member"."id"%TYPE,
+    "issue_id_p"  "issue"."id"%TYPE )
+  RETURNS BOOLEAN
+  LANGUAGE 'plpgsql' VOLATILE AS $$
+    BEGIN
+      PERFORM NULL FROM "issue"
+        WHERE "id" = "issue_id_p"
+        AND "state" = 'voting'
+        AND "phase_finished" ISNULL
+        FOR SHARE;
+      IF NOT FOUND THEN
+        RETURN FALSE;
+      END IF;
+      DELETE FROM "direct_voter"
+        WHERE "issue_id" = "issue_id_p" AND "member_id" = "member_id_p";
+      INSERT INTO "direct_voter" ("issue_id", "member_id")
+        VALUES ("issue_id_p", "member_id_p");
+      INSERT INTO "vote" ("initiative_id", "member_id", "grade")
+        SELECT "id", "member_id_p", floor(random() * 5)::INT4 - 2
+        FROM "initiative"
+        WHERE "issue_id" = "issue_id_p" AND "admitted";
+      RETURN TRUE;
+    EXCEPTION WHEN integrity_constraint_violation OR raise_exception THEN
+      RETURN FALSE;
+    END;
+  $$;
+
+-- post a message in an area:
+CREATE FUNCTION "workload"."post"
+  ( "member_id_p" "member"."id"%TYPE,
+    "area_id_p"   "area"."id"%TYPE )
+  RETURNS BOOLEAN
+  LANGUAGE 'plpgsql' VOLATILE AS $$
+    BEGIN
+      INSERT INTO "posting" ("author_id", "message", "unit_id", "area_id")
+        SELECT "member_id_p", 'Workload posting in area #' || "id", "unit_id", "id"
+        FROM "area" WHERE "id" = "area_id_p";
+      RETURN FOUND;
+    EXCEPTION WHEN integrity_constraint_violation OR raise_exception THEN
+      RETURN FALSE;
+    END;
+  $$;
@@ -0,0 +1,4 @@
+-- support or stop supporting an initiative (popular initiatives are chosen more often):
+\set member random(1, :members)
+\set initiative random_zipfian(1, :initiatives, 1.1)
+SELECT "workload"."support"(:member, :initiative);
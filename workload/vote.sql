@@ -0,0 +1,4 @@
+-- cast or replace a ballot for an issue (popular issues are chosen more often):
+\set member random(1, :members)
+\set issue random_zipfian(1, :issues, 1.1)
+SELECT "workload"."vote"(:member, :issue);